@@ -11,114 +11,109 @@ import UIKit
 
 enum CacheFetchResult {
     case hit(UIImage)
-    case wait
     case miss
 }
 
-/// CacheAgent manages a two-tier LRU cache for images
+/// CacheAgent manages a two-tier cache for images, each tier evicted by its own `CacheEvictionPolicy`
 internal actor CacheAgent {
     // MARK: - Properties
     /// All cached entries indexed by URL string
-    /// But it also act like a barrier, since this agent is actor, every access must be thread safe, if cache data contain that key -> it mean
+    /// Concurrent requests for a missing URL are coalesced by the manager, not here
     private var cacheData: [String: CacheEntry] = [:]
 
-    /// High priority LRU queue (least recent first, most recent last)
-    private var lowLatencyCache: [String] = []
-    private let lowLatencyLimit: Int
+    /// High priority tier (LRU by default)
+    private let lowLatencyCache: CacheEvictionPolicy
+    private let lowLatencyMemoryLimit: Int
     
-    /// Low priority LRU queue (least recent first, most recent last)
-    private var highLatencyCache: [String] = []
-    private let highLatencyLimit: Int
+    /// Low priority tier (LRU by default)
+    private let highLatencyCache: CacheEvictionPolicy
+    private let highLatencyMemoryLimit: Int
    
     private let config: CacheConfig
+
+    /// Lock-striped copy of the cached images, readable without hopping to the actor
+    nonisolated let shards = CacheShards()
     
     // MARK: - Initialization
     init(config: CacheConfig) {
         self.config = config
-        self.highLatencyLimit = config.highLatencyLimit
-        self.lowLatencyLimit = config.lowLatencyLimit
+        self.highLatencyMemoryLimit = config.highLatencyMemoryLimit
+        self.lowLatencyMemoryLimit = config.lowLatencyMemoryLimit
+        self.highLatencyCache = config.evictionPolicy.makePolicy(
+            countLimit: config.highLatencyLimit,
+            costLimit: config.highLatencyMemoryLimit
+        )
+        self.lowLatencyCache = config.evictionPolicy.makePolicy(
+            countLimit: config.lowLatencyLimit,
+            costLimit: config.lowLatencyMemoryLimit
+        )
     }
 
     deinit {
         NotificationCenter.default.removeObserver(self)
     }
 
+    // MARK: - Synchronous hit path
+    /// Get image from cache on the calling thread, nil on miss
+    /// The hit is recorded and applied to the LRU next time the actor runs
+    /// A URL equal by string but not by `URL` equality (relative vs absolute) only misses here
+    /// and is then served by `image(for:)`
+    nonisolated func cachedImage(for url: URL) -> UIImage? {
+        shards.image(for: url)
+    }
+
     // MARK: - Actor isolated set/get image
     /// Get image from cache and update LRU
     func image(for url: URL) -> CacheFetchResult {
+        applyPendingReads()
         let urlKey = url.absoluteString
         guard let entry = cacheData[urlKey] else {
-            cacheData[urlKey] = .default
             return .miss
         }
-        
-        if cacheData[urlKey] == .default {
-            return .wait
-        }
-        
 
-        // Update access time
-        // Update LRU: move to end (most recently used)
-        if entry.usuallyUpdate {
-            highLatencyCache.removeAll { $0 == urlKey }
-            highLatencyCache.append(urlKey)
-        } else {
-            lowLatencyCache.removeAll { $0 == urlKey }
-            lowLatencyCache.append(urlKey)
-        }
-        guard let image = cacheData[urlKey]?.image else {
-            return .miss
-        }
-        return .hit(image)
+        // Update recency / frequency
+        tier(isHighLatency: entry.usuallyUpdate).recordAccess(entry)
+        return .hit(entry.image)
     }
 
     /// Set image in cache with priority
     func setImage(_ image: UIImage, for url: URL,isHighLatency usuallyUpdate: Bool) async {
+        applyPendingReads()
         let urlKey = url.absoluteString
 
-        if cacheData[urlKey] == .default {
+        // An image bigger than the whole tier budget would flush the tier and still break the ceiling
+        guard fitsInBudget(image, isHighLatency: usuallyUpdate) else {
+            if let existingEntry = cacheData.removeValue(forKey: urlKey) {
+                tier(isHighLatency: existingEntry.usuallyUpdate).remove(existingEntry)
+                shards.remove(url: existingEntry.url)
+            }
+            return
+        }
+
+        if cacheData[urlKey] == nil {
             let entry = CacheEntry(image: image,
                                    url: url,
                                    usuallyUpdate: usuallyUpdate)
             cacheData[urlKey] = entry
-
-            if usuallyUpdate {
-                highLatencyCache.append(urlKey)
-            } else {
-                lowLatencyCache.append(urlKey)
-            }
-            evictMemory(isHighLatency: usuallyUpdate)
+            shards.set(entry)
+            tier(isHighLatency: usuallyUpdate).insert(entry, evict: drop)
         } else if let existingEntry = cacheData[urlKey] {
-            // Check if already exists with data
-            existingEntry.image = image
-
             // Update priority if changed
             if existingEntry.usuallyUpdate != usuallyUpdate {
                 // Remove from old cache (reverse logic -> if change from not usually to usually, the cache need clean is low latency)
-                if usuallyUpdate {
-                    lowLatencyCache.removeAll { $0 == urlKey }
-                } else {
-                    highLatencyCache.removeAll { $0 == urlKey }
-                }
+                tier(isHighLatency: existingEntry.usuallyUpdate).remove(existingEntry)
 
-                // Update priority
+                // Update priority and image
                 existingEntry.usuallyUpdate = usuallyUpdate
+                existingEntry.image = image
+                shards.set(existingEntry)
 
-                // Add to new unique set
-                if usuallyUpdate {
-                    highLatencyCache.append(urlKey)
-                } else {
-                    lowLatencyCache.append(urlKey)
-                }
+                // Add to new tier
+                tier(isHighLatency: usuallyUpdate).insert(existingEntry, evict: drop)
             } else {
-                // Just update LRU position (move to end)
-                if usuallyUpdate {
-                    highLatencyCache.removeAll { $0 == urlKey }
-                    highLatencyCache.append(urlKey)
-                } else {
-                    lowLatencyCache.removeAll { $0 == urlKey }
-                    lowLatencyCache.append(urlKey)
-                }
+                // Replace image (cost may change)
+                shards.set(existingEntry, image: image)
+                tier(isHighLatency: usuallyUpdate).replaceImage(of: existingEntry, with: image, evict: drop)
             }
         }
     }
@@ -130,28 +125,16 @@ internal actor CacheAgent {
         let urlKey = url.absoluteString
         guard let entry = cacheData[urlKey] else { return }
         
-        if entry.usuallyUpdate {
-            cacheData.removeValue(forKey: urlKey)
-            highLatencyCache.removeAll { $0 == urlKey }
-        } else {
-            cacheData.removeValue(forKey: urlKey)
-            lowLatencyCache.removeAll { $0 == urlKey }
-        }
+        cacheData.removeValue(forKey: urlKey)
+        tier(isHighLatency: entry.usuallyUpdate).remove(entry)
+        shards.remove(url: entry.url)
         return
     }
     
     func clearCache(isHighLatency: Bool) {
-        if isHighLatency {
-            for key in highLatencyCache {
-                cacheData.removeValue(forKey: key)
-            }
-            highLatencyCache.removeAll()
-            
-        } else {
-            for key in lowLatencyCache {
-                cacheData.removeValue(forKey: key)
-            }
-            lowLatencyCache.removeAll()
+        tier(isHighLatency: isHighLatency).removeAll { entry in
+            cacheData.removeValue(forKey: entry.key)
+            shards.remove(url: entry.url)
         }
         return
     }
@@ -161,6 +144,7 @@ internal actor CacheAgent {
         cacheData.removeAll()
         lowLatencyCache.removeAll()
         highLatencyCache.removeAll()
+        shards.removeAll()
     }
     
     /// Get high priority cache count
@@ -173,28 +157,45 @@ internal actor CacheAgent {
         lowLatencyCache.count
     }
 
+    /// Get high priority cache decoded size in bytes
+    func highLatencyCacheCost() -> Int {
+        highLatencyCache.totalCost
+    }
+
+    /// Get low priority cache decoded size in bytes
+    func lowLatencyCacheCost() -> Int {
+        lowLatencyCache.totalCost
+    }
+
     // MARK: - Private Methods
 
-    /// Evict least recently used low priority images if over limit
-    /// Low priority images are not saved to storage
-    private func evictMemory(isHighLatency: Bool) {
-        if isHighLatency {
-            while highLatencyCache.count > highLatencyLimit {
-                // Evict least recently used (first item)
-                let urlKey = highLatencyCache.first!
-                cacheData.removeValue(forKey: urlKey)
-                highLatencyCache.removeFirst()
-                // No need to save to storage for low priority
-            }
-        } else {
-            while lowLatencyCache.count > lowLatencyLimit {
-                // Evict least recently used (first item)
-                let urlKey = lowLatencyCache.first!
-                cacheData.removeValue(forKey: urlKey)
-                lowLatencyCache.removeFirst()
-                // No need to save to storage for low priority
-            }
+    /// Replay hits served by `cachedImage(for:)` into the tier policies
+    private func applyPendingReads() {
+        shards.drainReads { entry in
+            // Entry may have been evicted after the hit was recorded
+            guard entry.isLinked else { return }
+            tier(isHighLatency: entry.usuallyUpdate).recordAccess(entry)
         }
-        
+    }
+
+    private func tier(isHighLatency: Bool) -> CacheEvictionPolicy {
+        isHighLatency ? highLatencyCache : lowLatencyCache
+    }
+
+    /// Memory budget of a tier in bytes (0 = unlimited)
+    private func memoryLimit(isHighLatency: Bool) -> Int {
+        isHighLatency ? highLatencyMemoryLimit : lowLatencyMemoryLimit
+    }
+
+    private func fitsInBudget(_ image: UIImage, isHighLatency: Bool) -> Bool {
+        let budget = memoryLimit(isHighLatency: isHighLatency)
+        return budget <= 0 || CacheEntry.cost(of: image) <= budget
+    }
+
+    /// Forget an entry evicted by a tier policy
+    /// Evicted images are not saved to storage
+    private func drop(_ entry: CacheEntry) {
+        cacheData.removeValue(forKey: entry.key)
+        shards.remove(url: entry.url)
     }
 }
@@ -0,0 +1,124 @@
+//
+//  CacheShards.swift
+//  ImageDownloader
+//
+//  Lock-striped mirror of CacheAgent entries for synchronous cache hits
+//
+
+import Foundation
+import UIKit
+
+/// Lock-striped mirror of the images owned by `CacheAgent`
+/// - Reads are served on the calling thread, taking only the lock of one shard
+/// - Keyed by `URL` itself: a hit hashes the URL without building its `absoluteString`,
+///   so the read path allocates nothing
+/// - Writes come from the CacheAgent actor, so they are already serialized
+/// - Hits are recorded into a fixed size, lossy ring buffer per shard which the actor
+///   drains later to update recency, so a synchronous hit never hops to the actor
+internal final class CacheShards: @unchecked Sendable {
+    private struct Slot {
+        let image: UIImage
+        let entry: CacheEntry
+    }
+
+    private final class Shard {
+        let lock = NSLock()
+        var slots: [URL: Slot] = [:]
+        /// Entries hit through the synchronous path, preallocated so recording a hit never allocates
+        var readBuffer: [CacheEntry?]
+        var readBufferCount = 0
+
+        init(readBufferSize: Int) {
+            readBuffer = Array(repeating: nil, count: readBufferSize)
+        }
+    }
+
+    private let shards: [Shard]
+    private let shardMask: Int
+
+    /// - Parameters:
+    ///   - shardCount: Number of lock stripes, rounded up to a power of two
+    ///   - readBufferSize: Hits remembered per shard between two drains, extra hits are dropped
+    init(shardCount: Int = 16, readBufferSize: Int = 32) {
+        var count = 1
+        while count < max(1, shardCount) {
+            count <<= 1
+        }
+        self.shardMask = count - 1
+        self.shards = (0..<count).map { _ in Shard(readBufferSize: readBufferSize) }
+    }
+
+    // MARK: - Read path (any thread)
+
+    /// Get image for a URL and record the hit, nil on miss
+    func image(for url: URL) -> UIImage? {
+        let shard = shard(for: url)
+        shard.lock.lock()
+        defer { shard.lock.unlock() }
+
+        guard let slot = shard.slots[url] else {
+            return nil
+        }
+        if shard.readBufferCount < shard.readBuffer.count {
+            shard.readBuffer[shard.readBufferCount] = slot.entry
+            shard.readBufferCount += 1
+        }
+        return slot.image
+    }
+
+    // MARK: - Write path (CacheAgent only)
+
+    func set(_ entry: CacheEntry) {
+        set(entry, image: entry.image)
+    }
+
+    /// Publish `image` for an entry, used before the entry itself is updated
+    func set(_ entry: CacheEntry, image: UIImage) {
+        guard let url = entry.url else { return }
+        let shard = shard(for: url)
+        shard.lock.lock()
+        shard.slots[url] = Slot(image: image, entry: entry)
+        shard.lock.unlock()
+    }
+
+    func remove(url: URL?) {
+        guard let url = url else { return }
+        let shard = shard(for: url)
+        shard.lock.lock()
+        shard.slots.removeValue(forKey: url)
+        shard.lock.unlock()
+    }
+
+    func removeAll() {
+        for shard in shards {
+            shard.lock.lock()
+            shard.slots.removeAll()
+            for index in 0..<shard.readBufferCount {
+                shard.readBuffer[index] = nil
+            }
+            shard.readBufferCount = 0
+            shard.lock.unlock()
+        }
+    }
+
+    /// Replay and clear the recorded synchronous hits
+    func drainReads(_ body: (CacheEntry) -> Void) {
+        for shard in shards {
+            shard.lock.lock()
+            for index in 0..<shard.readBufferCount {
+                if let entry = shard.readBuffer[index] {
+                    body(entry)
+                }
+                shard.readBuffer[index] = nil
+            }
+            shard.readBufferCount = 0
+            shard.lock.unlock()
+        }
+    }
+
+    // MARK: - Private
+
+    private func shard(for url: URL) -> Shard {
+        shards[url.hashValue & shardMask]
+    }
+}
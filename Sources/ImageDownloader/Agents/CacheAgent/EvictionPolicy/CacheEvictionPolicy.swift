@@ -0,0 +1,108 @@
+//
+//  CacheEvictionPolicy.swift
+//  ImageDownloader
+//
+//  Pluggable eviction policy of one CacheAgent tier
+//
+
+import Foundation
+import UIKit
+
+/// Eviction policy of one cache tier
+/// Policies own the recency / frequency bookkeeping, CacheAgent owns the key -> entry table
+/// Not thread safe, the owner (CacheAgent actor) is responsible for isolation
+internal protocol CacheEvictionPolicy: AnyObject {
+    /// Number of entries held by this tier
+    var count: Int { get }
+    /// Sum of `CacheEntry.cost` held by this tier, in bytes
+    var totalCost: Int { get }
+
+    /// Add a new entry, calling `evict` for every entry dropped to stay in limits
+    /// The new entry itself may be evicted when the policy refuses to admit it
+    func insert(_ entry: CacheEntry, evict: (CacheEntry) -> Void)
+
+    /// Record a hit on an entry held by this tier
+    func recordAccess(_ entry: CacheEntry)
+
+    /// Replace the image of an entry held by this tier, calling `evict` if the new cost overflows limits
+    func replaceImage(of entry: CacheEntry, with image: UIImage, evict: (CacheEntry) -> Void)
+
+    /// Drop an entry without counting it as an eviction
+    func remove(_ entry: CacheEntry)
+
+    /// Drop every entry
+    func removeAll(_ body: (CacheEntry) -> Void)
+}
+
+extension CacheEvictionPolicy {
+    func removeAll() {
+        removeAll { _ in }
+    }
+}
+
+// MARK: - Factory
+extension IDCacheEvictionPolicy {
+    /// Build a policy instance for one tier
+    /// - Parameters:
+    ///   - countLimit: Maximum number of entries
+    ///   - costLimit: Maximum decoded bytes (0 = unlimited)
+    func makePolicy(countLimit: Int, costLimit: Int) -> CacheEvictionPolicy {
+        switch self {
+        case .lru:
+            return LRUEvictionPolicy(countLimit: countLimit, costLimit: costLimit)
+        case .tinyLFU:
+            return TinyLFUEvictionPolicy(countLimit: countLimit, costLimit: costLimit)
+        }
+    }
+}
+
+// MARK: - LRU
+/// Least recently used eviction, the default policy
+internal final class LRUEvictionPolicy: CacheEvictionPolicy {
+    private let list = LRUList()
+    private let countLimit: Int
+    private let costLimit: Int
+
+    init(countLimit: Int, costLimit: Int) {
+        self.countLimit = countLimit
+        self.costLimit = costLimit
+    }
+
+    var count: Int {
+        list.count
+    }
+
+    var totalCost: Int {
+        list.totalCost
+    }
+
+    func insert(_ entry: CacheEntry, evict: (CacheEntry) -> Void) {
+        list.append(entry)
+        trim(evict: evict)
+    }
+
+    func recordAccess(_ entry: CacheEntry) {
+        list.moveToTail(entry)
+    }
+
+    func replaceImage(of entry: CacheEntry, with image: UIImage, evict: (CacheEntry) -> Void) {
+        list.replaceImage(of: entry, with: image)
+        trim(evict: evict)
+    }
+
+    func remove(_ entry: CacheEntry) {
+        list.remove(entry)
+    }
+
+    func removeAll(_ body: (CacheEntry) -> Void) {
+        list.removeAll(body)
+    }
+
+    /// Evict least recently used entries while over entry limit or memory budget
+    private func trim(evict: (CacheEntry) -> Void) {
+        while list.count > countLimit || (costLimit > 0 && list.totalCost > costLimit),
+              let entry = list.popHead() {
+            evict(entry)
+        }
+    }
+}
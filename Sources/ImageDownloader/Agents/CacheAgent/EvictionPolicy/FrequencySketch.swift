@@ -0,0 +1,88 @@
+//
+//  FrequencySketch.swift
+//  ImageDownloader
+//
+//  Count-min sketch used by TinyLFU to estimate access frequency
+//
+
+import Foundation
+
+/// Count-min sketch with 4 rows of saturating counters (max 15) and periodic aging
+/// Every `sampleSize` increments all counters are halved, so old popularity fades out
+internal struct FrequencySketch {
+    private static let depth = 4
+    private static let maxCount: UInt8 = 15
+    private static let seeds: [UInt64] = [
+        0x9E37_79B9_7F4A_7C15,
+        0xC2B2_AE3D_27D4_EB4F,
+        0x1656_67B1_9E37_79F9,
+        0x85EB_CA77_C2B2_AE63
+    ]
+
+    private var table: [UInt8]
+    private let widthMask: Int
+    private let sampleSize: Int
+    private var additions: Int = 0
+
+    /// - Parameter capacity: Expected number of distinct hot keys (usually the cache entry limit)
+    init(capacity: Int) {
+        var width = 16
+        while width < capacity {
+            width <<= 1
+        }
+        self.widthMask = width - 1
+        self.sampleSize = max(10 * capacity, 16)
+        self.table = Array(repeating: 0, count: width * Self.depth)
+    }
+
+    /// Estimated number of recent accesses of a key
+    func frequency(of hash: Int) -> Int {
+        var result = Self.maxCount
+        for row in 0..<Self.depth {
+            result = min(result, table[index(of: hash, row: row)])
+        }
+        return Int(result)
+    }
+
+    /// Record one access of a key
+    mutating func increment(_ hash: Int) {
+        var added = false
+        for row in 0..<Self.depth {
+            let slot = index(of: hash, row: row)
+            if table[slot] < Self.maxCount {
+                table[slot] += 1
+                added = true
+            }
+        }
+
+        if added {
+            additions += 1
+            if additions >= sampleSize {
+                age()
+            }
+        }
+    }
+
+    mutating func reset() {
+        for slot in table.indices {
+            table[slot] = 0
+        }
+        additions = 0
+    }
+
+    // MARK: - Private
+
+    /// Halve every counter
+    private mutating func age() {
+        for slot in table.indices {
+            table[slot] >>= 1
+        }
+        additions /= 2
+    }
+
+    private func index(of hash: Int, row: Int) -> Int {
+        var mixed = UInt64(bitPattern: Int64(hash)) &* Self.seeds[row]
+        mixed ^= mixed >> 32
+        return row * (widthMask + 1) + (Int(truncatingIfNeeded: mixed) & widthMask)
+    }
+}
@@ -0,0 +1,166 @@
+//
+//  TinyLFUEvictionPolicy.swift
+//  ImageDownloader
+//
+//  Window-TinyLFU eviction policy
+//
+
+import Foundation
+import UIKit
+
+/// Window-TinyLFU eviction
+/// - New entries land in a small LRU window (1% of the tier)
+/// - Entries leaving the window compete with the probation victim of the main space,
+///   the one with the higher sketch frequency stays (admission filter)
+/// - Main space is a segmented LRU: probation (20%) and protected (80%),
+///   a hit in probation promotes the entry to protected
+/// So a burst of one-off images only churns the window and probation,
+/// while the frequently used set stays in protected
+internal final class TinyLFUEvictionPolicy: CacheEvictionPolicy {
+    private let window = LRUList()
+    private let probation = LRUList()
+    private let protected = LRUList()
+    private var sketch: FrequencySketch
+
+    private let windowCountLimit: Int
+    private let windowCostLimit: Int
+    private let mainCountLimit: Int
+    private let mainCostLimit: Int
+    private let protectedCountLimit: Int
+    private let protectedCostLimit: Int
+
+    init(countLimit: Int, costLimit: Int) {
+        let countLimit = max(countLimit, 1)
+        self.windowCountLimit = max(countLimit / 100, 1)
+        self.mainCountLimit = max(countLimit - windowCountLimit, 1)
+        self.protectedCountLimit = mainCountLimit * 8 / 10
+
+        // Cost limit 0 means unlimited, keep it 0 for every segment
+        self.windowCostLimit = costLimit > 0 ? max(costLimit / 100, 1) : 0
+        self.mainCostLimit = costLimit > 0 ? max(costLimit - windowCostLimit, 1) : 0
+        self.protectedCostLimit = mainCostLimit * 8 / 10
+
+        self.sketch = FrequencySketch(capacity: countLimit)
+    }
+
+    var count: Int {
+        window.count + probation.count + protected.count
+    }
+
+    var totalCost: Int {
+        window.totalCost + probation.totalCost + protected.totalCost
+    }
+
+    func insert(_ entry: CacheEntry, evict: (CacheEntry) -> Void) {
+        sketch.increment(entry.key.hashValue)
+        entry.segment = .window
+        window.append(entry)
+        trim(evict: evict)
+    }
+
+    func recordAccess(_ entry: CacheEntry) {
+        sketch.increment(entry.key.hashValue)
+        switch entry.segment {
+        case .window:
+            window.moveToTail(entry)
+        case .probation:
+            probation.remove(entry)
+            entry.segment = .protected
+            protected.append(entry)
+            demoteProtectedOverflow()
+        case .protected:
+            protected.moveToTail(entry)
+        }
+    }
+
+    func replaceImage(of entry: CacheEntry, with image: UIImage, evict: (CacheEntry) -> Void) {
+        list(for: entry.segment).replaceImage(of: entry, with: image)
+        demoteProtectedOverflow()
+        trim(evict: evict)
+    }
+
+    func remove(_ entry: CacheEntry) {
+        list(for: entry.segment).remove(entry)
+    }
+
+    func removeAll(_ body: (CacheEntry) -> Void) {
+        window.removeAll(body)
+        probation.removeAll(body)
+        protected.removeAll(body)
+        sketch.reset()
+    }
+
+    // MARK: - Private
+
+    private func list(for segment: CacheSegment) -> LRUList {
+        switch segment {
+        case .window:
+            return window
+        case .probation:
+            return probation
+        case .protected:
+            return protected
+        }
+    }
+
+    private func isOver(_ count: Int, _ cost: Int, countLimit: Int, costLimit: Int) -> Bool {
+        count > countLimit || (costLimit > 0 && cost > costLimit)
+    }
+
+    private var isMainOver: Bool {
+        isOver(probation.count + protected.count,
+               probation.totalCost + protected.totalCost,
+               countLimit: mainCountLimit,
+               costLimit: mainCostLimit)
+    }
+
+    /// Keep protected in its share by moving its LRU entries back to probation
+    private func demoteProtectedOverflow() {
+        while isOver(protected.count, protected.totalCost,
+                     countLimit: protectedCountLimit, costLimit: protectedCostLimit),
+              let demoted = protected.popHead() {
+            demoted.segment = .probation
+            probation.append(demoted)
+        }
+    }
+
+    /// Move window overflow to probation, then let each candidate fight the main victim
+    private func trim(evict: (CacheEntry) -> Void) {
+        while isOver(window.count, window.totalCost,
+                     countLimit: windowCountLimit, costLimit: windowCostLimit),
+              let candidate = window.popHead() {
+            candidate.segment = .probation
+            probation.append(candidate)
+            evictFromMain(candidate: candidate, evict: evict)
+        }
+        evictFromMain(candidate: nil, evict: evict)
+    }
+
+    /// Evict from main space until it fits
+    /// - Parameter candidate: Entry just admitted from the window, compared against the victim by frequency
+    private func evictFromMain(candidate: CacheEntry?, evict: (CacheEntry) -> Void) {
+        var candidate = candidate
+        while isMainOver {
+            guard let victim = probation.head ?? protected.head else { return }
+
+            guard let challenger = candidate, challenger !== victim else {
+                // No admission decision to make, plain LRU eviction
+                list(for: victim.segment).remove(victim)
+                evict(victim)
+                if victim === candidate {
+                    candidate = nil
+                }
+                continue
+            }
+
+            if sketch.frequency(of: challenger.key.hashValue) > sketch.frequency(of: victim.key.hashValue) {
+                list(for: victim.segment).remove(victim)
+                evict(victim)
+            } else {
+                probation.remove(challenger)
+                evict(challenger)
+                candidate = nil
+            }
+        }
+    }
+}
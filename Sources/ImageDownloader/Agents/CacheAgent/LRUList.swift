@@ -0,0 +1,102 @@
+//
+//  LRUList.swift
+//  ImageDownloader
+//
+//  Intrusive doubly-linked list used as LRU recency queue
+//  Touch, insert and evict are all O(1)
+//
+
+import Foundation
+import UIKit
+
+/// Intrusive LRU list of `CacheEntry` nodes (least recent at head, most recent at tail)
+/// Not thread safe, the owner (CacheAgent actor) is responsible for isolation
+internal final class LRUList {
+    /// Least recently used entry
+    private(set) var head: CacheEntry?
+    /// Most recently used entry
+    private(set) var tail: CacheEntry?
+    private(set) var count: Int = 0
+    /// Sum of `CacheEntry.cost` of all linked entries, in bytes
+    private(set) var totalCost: Int = 0
+
+    var isEmpty: Bool {
+        count == 0
+    }
+
+    /// Append entry as most recently used
+    func append(_ entry: CacheEntry) {
+        guard !entry.isLinked else {
+            moveToTail(entry)
+            return
+        }
+        entry.prev = tail
+        entry.next = nil
+        if let tail = tail {
+            tail.next = entry
+        } else {
+            head = entry
+        }
+        tail = entry
+        entry.isLinked = true
+        count += 1
+        totalCost += entry.cost
+    }
+
+    /// Unlink entry from the list
+    func remove(_ entry: CacheEntry) {
+        guard entry.isLinked else { return }
+        let prev = entry.prev
+        let next = entry.next
+
+        if let prev = prev {
+            prev.next = next
+        } else {
+            head = next
+        }
+        if let next = next {
+            next.prev = prev
+        } else {
+            tail = prev
+        }
+
+        entry.prev = nil
+        entry.next = nil
+        entry.isLinked = false
+        count -= 1
+        totalCost -= entry.cost
+    }
+
+    /// Replace the image of a linked entry, keeping `totalCost` in sync, and mark it most recently used
+    func replaceImage(of entry: CacheEntry, with image: UIImage) {
+        remove(entry)
+        entry.image = image
+        append(entry)
+    }
+
+    /// Mark entry as most recently used
+    func moveToTail(_ entry: CacheEntry) {
+        guard entry.isLinked else {
+            append(entry)
+            return
+        }
+        guard tail !== entry else { return }
+        remove(entry)
+        append(entry)
+    }
+
+    /// Remove and return least recently used entry
+    @discardableResult
+    func popHead() -> CacheEntry? {
+        guard let entry = head else { return nil }
+        remove(entry)
+        return entry
+    }
+
+    /// Unlink every node iteratively, so a long chain is not released recursively
+    func removeAll(_ body: (CacheEntry) -> Void = { _ in }) {
+        while let entry = popHead() {
+            body(entry)
+        }
+    }
+}
@@ -11,6 +11,12 @@ import Foundation
 struct CacheConfig {
     var highLatencyLimit: Int
     var lowLatencyLimit: Int
+    /// Decoded bytes budget of the high latency tier (0 = unlimited)
+    var highLatencyMemoryLimit: Int
+    /// Decoded bytes budget of the low latency tier (0 = unlimited)
+    var lowLatencyMemoryLimit: Int
+    /// Eviction policy used by both tiers
+    var evictionPolicy: IDCacheEvictionPolicy
     var clearLowPriorityOnMemoryWarning: Bool
     var clearAllOnMemoryWarning: Bool
 
@@ -18,11 +24,17 @@ struct CacheConfig {
     init(
         highLatencyLimit: Int = 50,
         lowLatencyLimit: Int = 100,
+        highLatencyMemoryLimit: Int = 50 * 1024 * 1024,
+        lowLatencyMemoryLimit: Int = 100 * 1024 * 1024,
+        evictionPolicy: IDCacheEvictionPolicy = .lru,
         clearLowPriorityOnMemoryWarning: Bool = true,
         clearAllOnMemoryWarning: Bool = false
     ) {
         self.highLatencyLimit = highLatencyLimit
         self.lowLatencyLimit = lowLatencyLimit
+        self.highLatencyMemoryLimit = highLatencyMemoryLimit
+        self.lowLatencyMemoryLimit = lowLatencyMemoryLimit
+        self.evictionPolicy = evictionPolicy
         self.clearLowPriorityOnMemoryWarning = clearLowPriorityOnMemoryWarning
         self.clearAllOnMemoryWarning = clearAllOnMemoryWarning
     }
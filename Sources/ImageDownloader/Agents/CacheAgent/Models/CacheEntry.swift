@@ -9,30 +9,59 @@
 import Foundation
 import UIKit
 
+/// Region of a segmented eviction policy an entry lives in
+enum CacheSegment {
+    case window
+    case probation
+    case protected
+}
+
 /// Internal cache entry tracking image, URL, access time, and priority
-class CacheEntry: Equatable {
-    var isDefault: Int
-    var image: UIImage
+/// The entry is also the node of its tier's intrusive LRU list (see `LRUList`)
+class CacheEntry {
+    var image: UIImage {
+        didSet { cost = Self.cost(of: image) }
+    }
     var url: URL?
+
+    /// Decoded byte cost of `image` charged against the tier memory budget
+    private(set) var cost: Int
     
     /// Every cache can be replace, but put on high process cache make the update is lesser than normal
     var usuallyUpdate: Bool
 
+    // MARK: - LRU node handles (owned by LRUList, do not touch directly)
+    /// Key of this entry inside `CacheAgent.cacheData`, needed to drop the dictionary slot on eviction
+    var key: String
+    /// Neighbour closer to the least recently used end (weak, the list owns nodes through `next`)
+    weak var prev: CacheEntry?
+    /// Neighbour closer to the most recently used end
+    var next: CacheEntry?
+    /// Whether this node is currently linked into a list
+    var isLinked: Bool = false
+    /// Segment holding this node, only meaningful for segmented policies (TinyLFU)
+    var segment: CacheSegment = .window
+
     init(
-        isDefault: Int = 0,
         image: UIImage,
         url: URL?,
         usuallyUpdate: Bool = false
     ) {
-        self.isDefault = isDefault
         self.image = image
         self.url = url
         self.usuallyUpdate = usuallyUpdate
+        self.key = url?.absoluteString ?? ""
+        self.cost = Self.cost(of: image)
     }
-    
-    static func ==(lhs: CacheEntry, rhs: CacheEntry) -> Bool {
-        return lhs.isDefault == rhs.isDefault && lhs.isDefault == 1
+
+    /// Decoded bitmap size (width * height * bytesPerPixel) of an image
+    static func cost(of image: UIImage) -> Int {
+        if let cgImage = image.cgImage {
+            return cgImage.bytesPerRow * cgImage.height
+        }
+        // Not backed by a CGImage yet, assume 4 bytes per pixel (RGBA)
+        let pixelWidth = Int(image.size.width * image.scale)
+        let pixelHeight = Int(image.size.height * image.scale)
+        return pixelWidth * pixelHeight * 4
     }
-    
-    static let `default`: CacheEntry = .init(isDefault: 1, image: UIImage(), url: nil)
 }
@@ -0,0 +1,124 @@
+//
+//  AdaptiveConcurrencyLimiter.swift
+//  ImageDownloader
+//
+//  Gradient based concurrency window for NetworkAgent
+//
+
+import Foundation
+
+/// Adaptive limit of concurrent downloads
+/// - Tracks a fast (recent) and a slow (baseline) moving average of request latency
+/// - Gradient = baseline / recent: while latency stays at baseline the window grows
+///   additively, when latency rises (queueing at the link or the server) it shrinks
+///   proportionally
+/// - Timeouts and connection failures halve the window (multiplicative decrease)
+/// - The window does not grow while it is not used (fewer downloads in flight than half the window)
+/// - Nor while it is bandwidth bound: a whole slot is only added when the previous one raised the
+///   aggregate throughput; after a step that did not, growth holds for `plateauHoldLength` downloads
+/// Not thread safe, access only from `NetworkAgent.isolationQueue`
+internal final class AdaptiveConcurrencyLimiter {
+    let minLimit: Int
+    let maxLimit: Int
+
+    /// Current window as a real number, smoothed
+    private var limit: Double
+    /// Fast moving average of latency (seconds)
+    private var recentLatency: Double = 0
+    /// Slow moving average of latency (seconds), the no-queueing baseline
+    private var baselineLatency: Double = 0
+    /// Moving average of aggregate throughput (bytes per second): download rate times downloads in flight
+    private(set) var throughput: Double = 0
+    /// Throughput when the window last took a whole slot, 0 = no reference yet
+    private var throughputAtLastStep: Double = 0
+    /// Downloads left before a plateaued window tries to grow again
+    private var plateauHold = 0
+
+    private let recentWeight = 0.2
+    private let baselineWeight = 0.02
+    private let smoothing = 0.2
+    /// Throughput gain a whole slot must bring to keep growing
+    private let minThroughputGain = 0.02
+    private let plateauHoldLength = 50
+
+    init(initialLimit: Int, minLimit: Int, maxLimit: Int) {
+        self.minLimit = max(1, minLimit)
+        self.maxLimit = max(self.minLimit, maxLimit)
+        self.limit = Double(min(max(initialLimit, self.minLimit), self.maxLimit))
+    }
+
+    /// Current concurrency window
+    var currentLimit: Int {
+        Int(limit.rounded(.down))
+    }
+
+    /// Record a finished download
+    /// - Parameters:
+    ///   - latency: Time to first byte when known, otherwise total request time
+    ///   - bytes: Bytes received
+    ///   - duration: Total request time
+    ///   - inFlight: Downloads running when this one finished (including it)
+    func recordSuccess(latency: TimeInterval, bytes: Int64, duration: TimeInterval, inFlight: Int) {
+        guard latency > 0 else { return }
+
+        if plateauHold > 0 {
+            plateauHold -= 1
+        }
+        if duration > 0 {
+            let sampleThroughput = Double(bytes) / duration * Double(max(inFlight, 1))
+            throughput = throughput == 0 ? sampleThroughput : throughput * (1 - recentWeight) + sampleThroughput * recentWeight
+        }
+
+        if baselineLatency == 0 {
+            baselineLatency = latency
+            recentLatency = latency
+            return
+        }
+        recentLatency = recentLatency * (1 - recentWeight) + latency * recentWeight
+        baselineLatency = baselineLatency * (1 - baselineWeight) + latency * baselineWeight
+
+        // Application limited, no information about a bigger window
+        if Double(inFlight) < limit / 2 {
+            return
+        }
+
+        let gradient = min(1.0, max(0.5, baselineLatency / recentLatency))
+        let headroom = limit.squareRoot()
+        let target = limit * gradient + headroom
+        var newLimit = limit * (1 - smoothing) + target * smoothing
+        if Int(newLimit.rounded(.down)) > currentLimit, !claimGrowthStep() {
+            newLimit = min(newLimit, limit)
+        }
+        update(newLimit)
+
+        // Let the baseline follow a permanently slower network instead of shrinking forever
+        if recentLatency > baselineLatency * 2 {
+            baselineLatency = baselineLatency * 0.9 + recentLatency * 0.1
+        }
+    }
+
+    /// Record a download that failed because of the network (timeout, connection lost)
+    func recordFailure() {
+        update(limit / 2)
+        throughputAtLastStep = 0
+    }
+
+    // MARK: - Private
+
+    /// Whether the window may take one more whole slot
+    private func claimGrowthStep() -> Bool {
+        guard plateauHold == 0 else { return false }
+        if throughputAtLastStep > 0, throughput < throughputAtLastStep * (1 + minThroughputGain) {
+            // The last slot brought nothing, probe again after the hold from a fresh reference
+            plateauHold = plateauHoldLength
+            throughputAtLastStep = 0
+            return false
+        }
+        throughputAtLastStep = throughput
+        return true
+    }
+
+    private func update(_ newLimit: Double) {
+        limit = min(Double(maxLimit), max(Double(minLimit), newLimit))
+    }
+}
@@ -0,0 +1,99 @@
+//
+//  CircuitBreaker.swift
+//  ImageDownloader
+//
+//  Per-host circuit breaker of NetworkAgent
+//
+
+import Foundation
+
+/// Stops sending requests to a host that keeps failing
+/// - Closed: requests go through, consecutive host failures are counted
+/// - Open: after `failureThreshold` consecutive failures, requests fail immediately for `openInterval`
+/// - Half-open: once `openInterval` elapsed a single probe goes through, its success closes the
+///   circuit, its failure opens it again
+/// Only host level failures count (timeouts, connection errors, 5xx), not 404 or decode errors
+/// Not thread safe, access only from `NetworkAgent.isolationQueue`
+internal final class CircuitBreaker {
+    enum State: Equatable {
+        case closed(failures: Int)
+        case open(until: Date)
+        case halfOpen(probeInFlight: Bool)
+    }
+
+    private let failureThreshold: Int
+    private let openInterval: TimeInterval
+    private var states: [String: State] = [:]
+
+    /// - Parameters:
+    ///   - failureThreshold: Consecutive failures opening the circuit (0 = never open)
+    ///   - openInterval: Seconds requests fail fast before a probe is allowed
+    init(failureThreshold: Int, openInterval: TimeInterval) {
+        self.failureThreshold = failureThreshold
+        self.openInterval = openInterval
+    }
+
+    var isEnabled: Bool {
+        failureThreshold > 0
+    }
+
+    /// Whether new requests to a host must fail fast right now
+    func isOpen(_ host: String, now: Date = Date()) -> Bool {
+        guard case .open(let until)? = states[host] else { return false }
+        return now < until
+    }
+
+    /// Ask to start a request to a host
+    /// - Returns: false when the circuit is open or a half-open probe is already running
+    func acquire(_ host: String, now: Date = Date()) -> Bool {
+        guard isEnabled else { return true }
+
+        switch states[host] ?? .closed(failures: 0) {
+        case .closed:
+            return true
+        case .open(let until):
+            guard now >= until else { return false }
+            states[host] = .halfOpen(probeInFlight: true)
+            return true
+        case .halfOpen(let probeInFlight):
+            guard !probeInFlight else { return false }
+            states[host] = .halfOpen(probeInFlight: true)
+            return true
+        }
+    }
+
+    func recordSuccess(_ host: String) {
+        states[host] = nil
+    }
+
+    func recordFailure(_ host: String, now: Date = Date()) {
+        guard isEnabled else { return }
+
+        switch states[host] ?? .closed(failures: 0) {
+        case .closed(let failures):
+            if failures + 1 >= failureThreshold {
+                states[host] = .open(until: now.addingTimeInterval(openInterval))
+            } else {
+                states[host] = .closed(failures: failures + 1)
+            }
+        case .halfOpen, .open:
+            states[host] = .open(until: now.addingTimeInterval(openInterval))
+        }
+    }
+
+    /// Request ended without telling anything about the host (cancelled, 404, ...)
+    /// Releases a half-open probe so another request can probe
+    func recordNeutral(_ host: String) {
+        if case .halfOpen? = states[host] {
+            states[host] = .halfOpen(probeInFlight: false)
+        }
+    }
+
+    /// Hosts whose circuit is open or half-open
+    var unavailableHosts: [String] {
+        states.compactMap { host, state in
+            if case .closed = state { return nil }
+            return host
+        }
+    }
+}
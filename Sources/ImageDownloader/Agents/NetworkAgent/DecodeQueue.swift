@@ -0,0 +1,99 @@
+//
+//  DecodeQueue.swift
+//  ImageDownloader
+//
+//  Bounded-parallel image decode stage, separate from NetworkAgent isolation queue
+//
+
+import Foundation
+import UIKit
+
+/// Decode pipeline stage shared by all NetworkAgent instances
+/// - Runs on its own concurrent queue, never on `NetworkAgent.isolationQueue`
+/// - At most one decode per active CPU core at a time
+/// - Waiting jobs are served by `DownloadPriority`, FIFO within the same priority
+internal final class DecodeQueue {
+
+    static let shared = DecodeQueue()
+
+    private struct Job {
+        let data: Data
+        let priority: DownloadPriority
+        let sequence: UInt64
+        let completion: (UIImage?) -> Void
+    }
+
+    private let maxConcurrentDecodes: Int
+    private let decoder: (Data) -> UIImage?
+    private let workQueue = DispatchQueue(
+        label: "com.imagedownloader.decode",
+        qos: .userInitiated,
+        attributes: .concurrent
+    )
+
+    // MARK: - Private State (Access only with lock)
+    private let lock = NSLock()
+    private var runningCount = 0
+    private var nextSequence: UInt64 = 0
+    private var pendingJobs = BinaryHeap<Job> { lhs, rhs in
+        if lhs.priority != rhs.priority {
+            return lhs.priority.isHigher(than: rhs.priority)
+        }
+        return lhs.sequence < rhs.sequence
+    }
+
+    /// - Parameters:
+    ///   - maxConcurrentDecodes: Decodes running at the same time
+    ///   - decoder: Turns a body into an image, called on a decode thread
+    init(
+        maxConcurrentDecodes: Int = ProcessInfo.processInfo.activeProcessorCount,
+        decoder: @escaping (Data) -> UIImage? = ImageDecoder.decodeImage(from:)
+    ) {
+        self.maxConcurrentDecodes = max(1, maxConcurrentDecodes)
+        self.decoder = decoder
+    }
+
+    /// Queue data for decoding, completion is called on a decode thread
+    func decode(
+        _ data: Data,
+        priority: DownloadPriority,
+        completion: @escaping (UIImage?) -> Void
+    ) {
+        lock.lock()
+        let job = Job(data: data, priority: priority, sequence: nextSequence, completion: completion)
+        nextSequence &+= 1
+
+        guard runningCount < maxConcurrentDecodes else {
+            pendingJobs.push(job)
+            lock.unlock()
+            return
+        }
+        runningCount += 1
+        lock.unlock()
+
+        run(job)
+    }
+
+    // MARK: - Private
+
+    private func run(_ job: Job) {
+        workQueue.async { [weak self, decoder] in
+            let image = decoder(job.data)
+            job.completion(image)
+            self?.runNext()
+        }
+    }
+
+    /// Free the slot of a finished job, or hand it to the next waiting job
+    private func runNext() {
+        lock.lock()
+        guard let next = pendingJobs.pop() else {
+            runningCount -= 1
+            lock.unlock()
+            return
+        }
+        lock.unlock()
+
+        run(next)
+    }
+}
@@ -0,0 +1,190 @@
+//
+//  HedgingPolicy.swift
+//  ImageDownloader
+//
+//  Hedged requests: a second identical request for downloads stuck before their first byte
+//
+
+import Foundation
+
+/// Decides when to hedge a download and how many hedges can be afforded
+/// - Delay: `percentile` of recent time-to-first-byte samples, so only the slowest tail is hedged
+/// - Budget: every download deposits `budgetRatio` token, every hedge withdraws one
+///   (0.05 = at most 5% extra requests once the small initial budget is used)
+/// Thread safe
+internal final class HedgingPolicy {
+    private let lock = NSLock()
+    private let percentile: Double
+    private let budgetRatio: Double
+    private let maxTokens: Double = 2
+    private var tokens: Double = 1
+
+    /// Ring buffer of recent time-to-first-byte samples
+    private var samples: [TimeInterval] = []
+    private var nextSampleIndex = 0
+    private let maxSamples = 128
+    /// No hedging before the percentile means something
+    private let minSamples = 20
+    /// Lower bound of the hedge delay, hedging sooner only doubles the load
+    private let minDelay: TimeInterval = 0.01
+
+    private var hedgesIssued = 0
+    private var hedgeWins = 0
+
+    /// - Parameters:
+    ///   - percentile: Time-to-first-byte percentile used as delay (0...1)
+    ///   - budgetRatio: Hedges allowed per download
+    init(percentile: Double, budgetRatio: Double) {
+        self.percentile = min(max(percentile, 0), 1)
+        self.budgetRatio = max(budgetRatio, 0)
+    }
+
+    /// Record a new download attempt (not a hedge)
+    func recordRequest() {
+        lock.lock()
+        tokens = min(maxTokens, tokens + budgetRatio)
+        lock.unlock()
+    }
+
+    /// Record time to first byte of a primary (not hedged) request
+    func recordFirstByte(_ latency: TimeInterval) {
+        lock.lock()
+        if samples.count < maxSamples {
+            samples.append(latency)
+        } else {
+            samples[nextSampleIndex] = latency
+        }
+        nextSampleIndex = (nextSampleIndex + 1) % maxSamples
+        lock.unlock()
+    }
+
+    /// Seconds to wait for a first byte before hedging, nil while there are too few samples
+    func hedgeDelay() -> TimeInterval? {
+        lock.lock()
+        let current = samples
+        lock.unlock()
+
+        guard current.count >= minSamples else { return nil }
+        let sorted = current.sorted()
+        let index = min(sorted.count - 1, Int((Double(sorted.count - 1) * percentile).rounded(.up)))
+        return max(sorted[index], minDelay)
+    }
+
+    /// Take a token for one hedge
+    /// - Returns: false when the budget is exhausted
+    func tryAcquire() -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard tokens >= 1 else { return false }
+        tokens -= 1
+        hedgesIssued += 1
+        return true
+    }
+
+    /// The hedge finished before the original request
+    func recordWin() {
+        lock.lock()
+        hedgeWins += 1
+        lock.unlock()
+    }
+
+    /// Hedges sent and hedges that finished first
+    var counts: (issued: Int, wins: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        return (hedgesIssued, hedgeWins)
+    }
+}
+
+/// One download attempt made of a primary request and possibly a hedge
+/// - The first request to receive a byte leads: only its progress and partial data are reported
+/// - The first request to finish successfully wins and the other one is cancelled
+/// - A failure is only reported when no other request is still running
+/// Thread safe
+internal final class HedgedAttempt {
+    private let lock = NSLock()
+    private let completion: StreamingDownload.Completion
+    private let onHedgeWin: () -> Void
+
+    /// Running requests: taskIdentifier -> task
+    private var running: [Int: URLSessionTask] = [:]
+    private var hedgeIdentifier: Int?
+    private var leaderIdentifier: Int?
+    private var _isFinished = false
+
+    init(completion: @escaping StreamingDownload.Completion, onHedgeWin: @escaping () -> Void) {
+        self.completion = completion
+        self.onHedgeWin = onHedgeWin
+    }
+
+    var isFinished: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return _isFinished
+    }
+
+    /// Whether a request already received its first byte
+    var hasFirstByte: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return leaderIdentifier != nil
+    }
+
+    /// Join a request to the attempt, call before `resume()`
+    /// - Returns: false when the attempt already finished, the request must not be started
+    func add(_ sessionTask: URLSessionTask, isHedge: Bool) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard !_isFinished else { return false }
+        running[sessionTask.taskIdentifier] = sessionTask
+        if isHedge {
+            hedgeIdentifier = sessionTask.taskIdentifier
+        }
+        return true
+    }
+
+    /// Record a first byte
+    /// - Returns: true if this request is the leader
+    func claimFirstByte(_ identifier: Int) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        if leaderIdentifier == nil {
+            leaderIdentifier = identifier
+        }
+        return leaderIdentifier == identifier
+    }
+
+    /// Whether progress and data of a request should be reported
+    func isLeading(_ identifier: Int) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return leaderIdentifier == nil || leaderIdentifier == identifier
+    }
+
+    /// A request of the attempt finished
+    func complete(_ identifier: Int, data: Data?, response: URLResponse?, error: Error?) {
+        lock.lock()
+        guard !_isFinished, running.removeValue(forKey: identifier) != nil else {
+            lock.unlock()
+            return
+        }
+        // Failed, but the other request may still succeed
+        if error != nil, !running.isEmpty {
+            lock.unlock()
+            return
+        }
+        _isFinished = true
+        let losers = Array(running.values)
+        running.removeAll()
+        let wonByHedge = error == nil && identifier == hedgeIdentifier
+        lock.unlock()
+
+        for loser in losers {
+            loser.cancel()
+        }
+        if wonByHedge {
+            onHedgeWin()
+        }
+        completion(data, response, error)
+    }
+}
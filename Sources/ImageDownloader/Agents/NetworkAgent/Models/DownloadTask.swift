@@ -6,38 +6,213 @@
 //
 
 import Foundation
+import UIKit
 
 /// Represents an active download task
+/// All waiters share one download and one decode: the bytes are decoded once
+/// and the same UIImage instance is handed to every waiter
 internal final class DownloadTask {
     let url: URL
-    let priority: DownloadPriority
     let startTime: Date
-    var urlSessionTask: URLSessionDataTask?
+    /// Validators of the stored copy, the request is conditional when set
+    let validators: ResourceValidators?
+    /// Request of the current attempt, set from download threads and read by `cancel()`
+    var urlSessionTask: URLSessionDataTask? {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return _urlSessionTask
+        }
+        set {
+            lock.lock()
+            _urlSessionTask = newValue
+            let priority = _priority
+            lock.unlock()
+            newValue?.priority = priority.urlSessionTaskPriority
+        }
+    }
+    private var _urlSessionTask: URLSessionDataTask?
+
+    /// Hedge racing `urlSessionTask`, cancelled and re-prioritized with it
+    var hedgeSessionTask: URLSessionDataTask? {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return _hedgeSessionTask
+        }
+        set {
+            lock.lock()
+            _hedgeSessionTask = newValue
+            let priority = _priority
+            lock.unlock()
+            newValue?.priority = priority.urlSessionTaskPriority
+        }
+    }
+    private var _hedgeSessionTask: URLSessionDataTask?
+
+    /// Time to first byte of the last attempt, set by the streaming download
+    var timeToFirstByte: TimeInterval? {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return _timeToFirstByte
+        }
+        set {
+            lock.lock()
+            _timeToFirstByte = newValue
+            lock.unlock()
+        }
+    }
+    private var _timeToFirstByte: TimeInterval?
+
+    /// Current priority, changed by re-prioritization or inherited from a more urgent joiner
+    /// Applied to the running URLSessionTask and to the decode stage
+    var priority: DownloadPriority {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return _priority
+        }
+        set {
+            lock.lock()
+            _priority = newValue
+            let sessionTask = _urlSessionTask
+            let hedgeTask = _hedgeSessionTask
+            lock.unlock()
+            sessionTask?.priority = newValue.urlSessionTaskPriority
+            hedgeTask?.priority = newValue.urlSessionTaskPriority
+        }
+    }
+    private var _priority: DownloadPriority
 
     private let lock = NSLock()
-    private var waiters: [(completion: InternalDownloadCompletionHandler,
-                           progress: DownloadProgressHandler?)] = []
+    private var waiters: [(token: DownloadToken,
+                           completion: DownloadCompletionHandler,
+                           progress: DownloadProgressHandler?,
+                           partialImage: DownloadPartialImageHandler?,
+                           response: DownloadResponseHandler?,
+                           data: DownloadDataHandler?)] = []
+
+    /// Minimum seconds between two partial frames
+    private let progressiveInterval: TimeInterval
+    /// Decode stage of the finished body
+    private let decodeQueue: DecodeQueue
+    /// Created on the first chunk when a waiter wants partial frames
+    private var progressiveDecoder: ProgressiveDecoder?
+    /// Bytes fed to the decoder, a shorter body means a retry restarted the download
+    private var progressiveByteCount = 0
 
-    init(url: URL, priority: DownloadPriority) {
+    init(
+        url: URL,
+        priority: DownloadPriority,
+        validators: ResourceValidators? = nil,
+        progressiveInterval: TimeInterval = 0.25,
+        decodeQueue: DecodeQueue = .shared
+    ) {
         self.url = url
-        self.priority = priority
+        self.decodeQueue = decodeQueue
+        self.validators = validators
+        self._priority = priority
+        self.progressiveInterval = progressiveInterval
         self.startTime = Date()
     }
 
-    func addWaiter(completion: @escaping InternalDownloadCompletionHandler, progress: DownloadProgressHandler?) {
+    func addWaiter(
+        token: DownloadToken,
+        completion: @escaping DownloadCompletionHandler,
+        progress: DownloadProgressHandler?,
+        partialImage: DownloadPartialImageHandler? = nil,
+        response: DownloadResponseHandler? = nil,
+        data: DownloadDataHandler? = nil
+    ) {
+        lock.lock()
+        waiters.append((token, completion, progress, partialImage, response, data))
+        lock.unlock()
+    }
+
+    /// Drop the waiter of a cancelled caller, it is not notified anymore
+    /// - Returns: Its completion and the number of waiters left, nil when the token is not a waiter
+    func removeWaiter(_ token: DownloadToken) -> (completion: DownloadCompletionHandler, remaining: Int)? {
+        lock.lock()
+        defer { lock.unlock() }
+        guard let index = waiters.firstIndex(where: { $0.token === token }) else { return nil }
+        let waiter = waiters.remove(at: index)
+        return (waiter.completion, waiters.count)
+    }
+
+    /// Callers still waiting for this download
+    var waiterCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return waiters.count
+    }
+
+    /// Hand the validated HTTP response (2xx or 304) to waiters, before completion
+    func notifyResponse(_ response: HTTPURLResponse, bodyLength: Int64) {
+        lock.lock()
+        let currentWaiters = waiters
+        lock.unlock()
+
+        for waiter in currentWaiters {
+            waiter.response?(response, bodyLength)
+        }
+    }
+
+    /// Feed the body received so far to progressive decoding
+    /// No-op unless a waiter asked for partial images
+    func receivedPartialData(_ data: Data) {
         lock.lock()
-        waiters.append((completion, progress))
+        guard waiters.contains(where: { $0.partialImage != nil }) else {
+            lock.unlock()
+            return
+        }
+        if progressiveDecoder == nil || data.count < progressiveByteCount {
+            progressiveDecoder?.finish()
+            progressiveDecoder = ProgressiveDecoder(minInterval: progressiveInterval) { [weak self] frame in
+                self?.notifyPartialImage(frame)
+            }
+        }
+        progressiveByteCount = data.count
+        let decoder = progressiveDecoder
         lock.unlock()
+
+        decoder?.update(with: data)
     }
 
-    func notifyAllWaiters(data: Data?, error: Error?) {
+    /// Decode downloaded data once on the decode stage, then notify every waiter with the shared image
+    /// Returns immediately, waiters are called from a decode thread
+    /// - Parameter decoded: Called with the decode result (not called when there was nothing to decode)
+    func notifyAllWaiters(data: Data?, error: Error?, decoded: ((UIImage?) -> Void)? = nil) {
         lock.lock()
         let currentWaiters = waiters
         waiters.removeAll()
+        let decoder = progressiveDecoder
+        progressiveDecoder = nil
         lock.unlock()
 
+        // Final image comes from the decode stage, no more partial frames
+        decoder?.finish()
+
+        guard !currentWaiters.isEmpty else { return }
+
+        guard error == nil, let data = data else {
+            for waiter in currentWaiters {
+                waiter.completion(nil, error)
+            }
+            return
+        }
+
+        // Raw bytes go to their consumers (storage) now, the write overlaps the decode
         for waiter in currentWaiters {
-            waiter.completion(data, error)
+            waiter.data?(data)
+        }
+
+        decodeQueue.decode(data, priority: priority) { image in
+            decoded?(image)
+            let decodeError: Error? = image == nil ? ImageDownloaderError.decodingFailed : nil
+            for waiter in currentWaiters {
+                waiter.completion(image, decodeError)
+            }
         }
     }
 
@@ -51,7 +226,32 @@ internal final class DownloadTask {
         }
     }
 
+    private func notifyPartialImage(_ image: UIImage) {
+        lock.lock()
+        let currentWaiters = waiters
+        lock.unlock()
+
+        for waiter in currentWaiters {
+            waiter.partialImage?(image)
+        }
+    }
+
+    /// Set by `cancel()`, a retry waiting for its delay does not start
+    var isCancelled: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return _isCancelled
+    }
+    private var _isCancelled = false
+
+    /// A request stored after this call is cancelled by its owner re-checking `isCancelled`
     func cancel() {
-        urlSessionTask?.cancel()
+        lock.lock()
+        _isCancelled = true
+        let sessionTask = _urlSessionTask
+        let hedgeTask = _hedgeSessionTask
+        lock.unlock()
+        sessionTask?.cancel()
+        hedgeTask?.cancel()
     }
 }
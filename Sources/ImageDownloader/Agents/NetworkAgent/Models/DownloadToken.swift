@@ -0,0 +1,18 @@
+//
+//  DownloadToken.swift
+//  ImageDownloader
+//
+//  Handle of one caller of a shared download
+//
+
+import Foundation
+
+/// Returned by `NetworkAgent.downloadData`, identifies one waiter of a (possibly shared) download
+/// Cancelling a token only drops that waiter, the download stops when its last waiter is cancelled
+internal final class DownloadToken {
+    let url: URL
+
+    init(url: URL) {
+        self.url = url
+    }
+}
@@ -10,27 +10,97 @@ import Foundation
 /// Internal network configuration with standard settings
 struct NetworkConfig {
     var maxConcurrentDownloads: Int
+    /// Slots a single host may use at once (-1 = half of the concurrency window, 0 = no per host limit)
+    var maxConcurrentDownloadsPerHost: Int
     var timeout: TimeInterval
     var allowsCellularAccess: Bool
     var retryPolicy: RetryPolicy
     var customHeaders: [String: String]?
     var authenticationHandler: ((inout URLRequest) -> Void)?
+    /// Seconds a queued request has to wait to be served like one priority level higher
+    var priorityAgingInterval: TimeInterval
+    /// Seconds a request may wait for a slot when it has no deadline of its own
+    var pendingRequestTimeout: TimeInterval
+    /// Requests waiting for a slot at most (0 = unbounded)
+    var maxPendingDownloads: Int
+    /// What to drop when `maxPendingDownloads` is reached
+    var pendingOverflowPolicy: IDQueueOverflowPolicy
+    /// Minimum seconds between two progress reports of a download (0 = every received chunk)
+    var progressInterval: TimeInterval
+    /// Minimum seconds between two partial frames of a progressive download
+    var progressiveDecodingInterval: TimeInterval
+    /// Bytes of interrupted bodies kept to resume with range requests (0 = never resume)
+    var partialDownloadsMemoryLimit: Int
+    /// Retries allowed per download across the agent, see `RetryBudget`
+    var retryBudgetRatio: Double
+    /// Consecutive host failures opening its circuit (0 = no circuit breaker)
+    var circuitBreakerFailureThreshold: Int
+    /// Seconds requests to a host with an open circuit fail fast
+    var circuitBreakerOpenInterval: TimeInterval
+    /// Seconds a 404 or repeated decode failure of a URL is remembered (0 = not remembered)
+    var negativeCacheTTL: TimeInterval
+    /// Adjust concurrency window from observed latency, starting at `maxConcurrentDownloads`
+    var adaptiveConcurrency: Bool
+    var minAdaptiveConcurrentDownloads: Int
+    var maxAdaptiveConcurrentDownloads: Int
+    /// Send a second request for downloads without a first byte after the `hedgePercentile` delay
+    var hedgingEnabled: Bool
+    /// Time-to-first-byte percentile waited before hedging (0...1)
+    var hedgePercentile: Double
+    /// Hedges allowed per download, see `HedgingPolicy`
+    var hedgeBudgetRatio: Double
 
     // Default initializer
     init(
         maxConcurrentDownloads: Int = 4,
+        maxConcurrentDownloadsPerHost: Int = -1,
         timeout: TimeInterval = 30,
         allowsCellularAccess: Bool = true,
         retryPolicy: RetryPolicy = .default,
         customHeaders: [String: String]? = nil,
-        authenticationHandler: ((inout URLRequest) -> Void)? = nil
+        authenticationHandler: ((inout URLRequest) -> Void)? = nil,
+        priorityAgingInterval: TimeInterval = 5,
+        pendingRequestTimeout: TimeInterval = 60,
+        maxPendingDownloads: Int = 0,
+        pendingOverflowPolicy: IDQueueOverflowPolicy = .dropOldestLowPriority,
+        progressInterval: TimeInterval = 0.1,
+        progressiveDecodingInterval: TimeInterval = 0.25,
+        partialDownloadsMemoryLimit: Int = 20 * 1024 * 1024,
+        retryBudgetRatio: Double = 0.1,
+        circuitBreakerFailureThreshold: Int = 5,
+        circuitBreakerOpenInterval: TimeInterval = 30,
+        negativeCacheTTL: TimeInterval = 300,
+        adaptiveConcurrency: Bool = false,
+        minAdaptiveConcurrentDownloads: Int = 1,
+        maxAdaptiveConcurrentDownloads: Int = 16,
+        hedgingEnabled: Bool = false,
+        hedgePercentile: Double = 0.95,
+        hedgeBudgetRatio: Double = 0.05
     ) {
         self.maxConcurrentDownloads = maxConcurrentDownloads
+        self.maxConcurrentDownloadsPerHost = maxConcurrentDownloadsPerHost
         self.timeout = timeout
         self.allowsCellularAccess = allowsCellularAccess
         self.retryPolicy = retryPolicy
         self.customHeaders = customHeaders
         self.authenticationHandler = authenticationHandler
+        self.priorityAgingInterval = priorityAgingInterval
+        self.pendingRequestTimeout = pendingRequestTimeout
+        self.maxPendingDownloads = maxPendingDownloads
+        self.pendingOverflowPolicy = pendingOverflowPolicy
+        self.progressInterval = progressInterval
+        self.progressiveDecodingInterval = progressiveDecodingInterval
+        self.partialDownloadsMemoryLimit = partialDownloadsMemoryLimit
+        self.retryBudgetRatio = retryBudgetRatio
+        self.circuitBreakerFailureThreshold = circuitBreakerFailureThreshold
+        self.circuitBreakerOpenInterval = circuitBreakerOpenInterval
+        self.negativeCacheTTL = negativeCacheTTL
+        self.adaptiveConcurrency = adaptiveConcurrency
+        self.minAdaptiveConcurrentDownloads = minAdaptiveConcurrentDownloads
+        self.maxAdaptiveConcurrentDownloads = maxAdaptiveConcurrentDownloads
+        self.hedgingEnabled = hedgingEnabled
+        self.hedgePercentile = hedgePercentile
+        self.hedgeBudgetRatio = hedgeBudgetRatio
     }
 }
 
@@ -0,0 +1,66 @@
+//
+//  PartialDownload.swift
+//  ImageDownloader
+//
+//  Body prefix of an interrupted download that can be resumed
+//
+
+import Foundation
+
+/// Bytes received before a download was interrupted, with what is needed to resume it
+/// Resumed with `Range: bytes=<count>-` and `If-Range: <validator>`: the server answers 206 with the
+/// rest when the resource did not change, or 200 with the whole new body when it did
+struct PartialDownload {
+    let data: Data
+    /// Strong ETag, else Last-Modified of the original response
+    let validator: String
+    /// Size of the whole body, -1 if unknown
+    let totalLength: Int64
+
+    /// - Returns: nil when the response does not allow resuming (no `Accept-Ranges: bytes`,
+    ///   no strong validator) or nothing was received
+    init?(data: Data, response: HTTPURLResponse) {
+        guard !data.isEmpty,
+              response.statusCode == 200,
+              response.value(forHTTPHeaderField: "Accept-Ranges")?.lowercased().contains("bytes") == true else {
+            return nil
+        }
+
+        // Weak ETags cannot be used with If-Range
+        if let etag = response.value(forHTTPHeaderField: "ETag"), !etag.hasPrefix("W/") {
+            self.validator = etag
+        } else if let lastModified = response.value(forHTTPHeaderField: "Last-Modified") {
+            self.validator = lastModified
+        } else {
+            return nil
+        }
+        self.data = data
+        self.totalLength = response.expectedContentLength
+    }
+
+    /// Longer prefix of the same resource, after a resumed attempt was interrupted again
+    /// - Parameter data: Whole prefix, the previous one included
+    init(data: Data, continuing previous: PartialDownload) {
+        self.data = data
+        self.validator = previous.validator
+        self.totalLength = previous.totalLength
+    }
+
+    /// Add `Range` / `If-Range` headers to resume after the stored prefix
+    func apply(to request: inout URLRequest) {
+        request.setValue("bytes=\(data.count)-", forHTTPHeaderField: "Range")
+        request.setValue(validator, forHTTPHeaderField: "If-Range")
+    }
+
+    /// Whether a 206 answer continues exactly after the stored prefix
+    func isContinued(by response: HTTPURLResponse) -> Bool {
+        // Content-Range: bytes <start>-<end>/<total>
+        guard response.statusCode == 206,
+              let contentRange = response.value(forHTTPHeaderField: "Content-Range"),
+              let range = contentRange.split(separator: " ").last,
+              let start = range.split(separator: "-").first.flatMap({ Int64($0) }) else {
+            return false
+        }
+        return start == Int64(data.count)
+    }
+}
@@ -8,30 +8,62 @@
 import Foundation
 
 /// Represents a pending download request waiting for a slot
-internal struct PendingDownloadRequest {
+/// Reference type so it can act as the handle of its `PendingQueue` slot
+internal final class PendingDownloadRequest {
     let url: URL
-    let priority: DownloadPriority
+    /// Caller handle, see `NetworkAgent.cancelDownload(_:)`
+    let token: DownloadToken
+    /// Host the request is scheduled under, see `PendingQueue`
+    let host: String
+    /// Can change while queued, see `PendingQueue.updatePriority`
+    var priority: DownloadPriority
     let progress: DownloadProgressHandler?
+    let partialImage: DownloadPartialImageHandler?
+    let response: DownloadResponseHandler?
+    let data: DownloadDataHandler?
+    let validators: ResourceValidators?
     let completion: DownloadCompletionHandler
     let enqueueTime: Date
-    let timeout: TimeInterval
+    /// Failed with `.timeout` when still queued at this date, see `PendingQueue.removeExpired`
+    var deadline: Date
+
+    // MARK: - Queue handle (owned by PendingQueue)
+    /// Scheduling key, smaller is served first
+    var schedulingKey: TimeInterval = 0
+    /// Tie breaker keeping FIFO order for equal keys
+    var sequence: UInt64 = 0
+    /// Position in the host heap, nil when not queued
+    var heapIndex: Int?
+    /// Position in the deadline heap, nil when not queued
+    var deadlineHeapIndex: Int?
 
     init(
         url: URL,
+        token: DownloadToken,
         priority: DownloadPriority,
         progress: DownloadProgressHandler?,
+        partialImage: DownloadPartialImageHandler? = nil,
+        response: DownloadResponseHandler? = nil,
+        data: DownloadDataHandler? = nil,
+        validators: ResourceValidators? = nil,
         completion: @escaping DownloadCompletionHandler,
-        timeout: TimeInterval = 60.0
+        deadline: Date
     ) {
         self.url = url
+        self.token = token
+        self.host = url.host ?? ""
         self.priority = priority
         self.progress = progress
+        self.partialImage = partialImage
+        self.response = response
+        self.data = data
+        self.validators = validators
         self.completion = completion
         self.enqueueTime = Date()
-        self.timeout = timeout
+        self.deadline = deadline
     }
 
     var isExpired: Bool {
-        Date().timeIntervalSince(enqueueTime) > timeout
+        Date() >= deadline
     }
 }
@@ -0,0 +1,146 @@
+//
+//  StreamingDownload.swift
+//  ImageDownloader
+//
+//  Per URLSessionTask state of a delegate-driven download
+//
+
+import Foundation
+
+/// Collects the body of one URLSessionDataTask as it streams in
+/// - Buffer is preallocated from `Content-Length` when the server sends it, up to `maxPreallocatedBytes`
+/// - Resumes after a `PartialDownload` prefix when the server answers the range request with 206,
+///   and hands a resumable prefix to `onInterrupted` when the transfer fails midway
+/// - Progress is reported at most once per `progressInterval`, the final report is left to the
+///   owner once the response is validated
+/// Driven by `SessionDelegate`, whose delegate queue is serial, so no locking is needed
+internal final class StreamingDownload {
+    typealias Completion = (_ data: Data?, _ response: URLResponse?, _ error: Error?) -> Void
+
+    /// Largest buffer allocated up front from `Content-Length`
+    static let maxPreallocatedBytes: Int64 = 16 * 1024 * 1024
+
+    private let progressInterval: TimeInterval
+    private let onProgress: DownloadProgressHandler?
+    private let onFirstByte: ((TimeInterval) -> Void)?
+    private let onData: ((Data) -> Void)?
+    private let onInterrupted: ((PartialDownload) -> Void)?
+    private let resumeFrom: PartialDownload?
+    private let completion: Completion
+
+    private var buffer = Data()
+    private var response: URLResponse?
+    private var expectedBytes: Int64 = -1
+    /// Prefix bytes reused from `resumeFrom`, 0 when the body started from scratch
+    private var resumedBytes = 0
+    /// Server answered 206 for another range than the one asked
+    private var isRangeMismatch = false
+    private let startTime = Date()
+    private var firstByteTime: Date?
+    private var lastProgressTime: Date?
+
+    /// - Parameters:
+    ///   - progressInterval: Minimum seconds between two progress reports (0 = every chunk)
+    ///   - onProgress: Progress handler, called on the session delegate queue
+    ///   - onFirstByte: Called once with the time to first byte
+    ///   - onData: Called after every chunk with the body received so far
+    ///   - resumeFrom: Prefix the request asked to resume after (`Range` header set by the owner)
+    ///   - onInterrupted: Called with the resumable prefix when the transfer fails midway
+    ///   - completion: Called once with the whole body or the error
+    init(
+        progressInterval: TimeInterval,
+        onProgress: DownloadProgressHandler?,
+        onFirstByte: ((TimeInterval) -> Void)?,
+        onData: ((Data) -> Void)? = nil,
+        resumeFrom: PartialDownload? = nil,
+        onInterrupted: ((PartialDownload) -> Void)? = nil,
+        completion: @escaping Completion
+    ) {
+        self.progressInterval = progressInterval
+        self.onProgress = onProgress
+        self.onFirstByte = onFirstByte
+        self.onData = onData
+        self.resumeFrom = resumeFrom
+        self.onInterrupted = onInterrupted
+        self.completion = completion
+    }
+
+    func didReceive(response: URLResponse) {
+        self.response = response
+        expectedBytes = response.expectedContentLength
+
+        // 206 continues the stored prefix, 200 means the resource changed and the body restarts
+        if let resumeFrom = resumeFrom, let httpResponse = response as? HTTPURLResponse, httpResponse.statusCode == 206 {
+            if resumeFrom.isContinued(by: httpResponse) {
+                buffer = resumeFrom.data
+                resumedBytes = buffer.count
+                expectedBytes = expectedBytes > 0 ? expectedBytes + Int64(resumedBytes) : resumeFrom.totalLength
+            } else {
+                isRangeMismatch = true
+            }
+        }
+
+        // Content-Length is not trusted beyond a cap, a bigger body grows the buffer as it arrives
+        if expectedBytes > 0 {
+            buffer.reserveCapacity(Int(min(expectedBytes, Self.maxPreallocatedBytes)))
+        }
+        if firstByteTime == nil {
+            let now = Date()
+            firstByteTime = now
+            onFirstByte?(now.timeIntervalSince(startTime))
+        }
+    }
+
+    func didReceive(data: Data) {
+        buffer.append(data)
+        onData?(buffer)
+
+        guard let onProgress = onProgress else { return }
+        let now = Date()
+        if let last = lastProgressTime, now.timeIntervalSince(last) < progressInterval {
+            return
+        }
+        lastProgressTime = now
+        onProgress(currentProgress(at: now))
+    }
+
+    func didComplete(error: Error?) {
+        if let error = error {
+            if let partial = interruptedPartial() {
+                onInterrupted?(partial)
+            }
+            completion(nil, response, error)
+            return
+        }
+        if isRangeMismatch {
+            completion(nil, response, ImageDownloaderError.networkError(
+                NSError(domain: "ImageDownloader", code: -1,
+                        userInfo: [NSLocalizedDescriptionKey: "Unexpected Content-Range"])
+            ))
+            return
+        }
+        completion(buffer, response, nil)
+    }
+
+    // MARK: - Private
+
+    private func interruptedPartial() -> PartialDownload? {
+        guard !isRangeMismatch, let httpResponse = response as? HTTPURLResponse else { return nil }
+        if resumedBytes > 0, let resumeFrom = resumeFrom {
+            return PartialDownload(data: buffer, continuing: resumeFrom)
+        }
+        return PartialDownload(data: buffer, response: httpResponse)
+    }
+
+    private func currentProgress(at now: Date) -> DownloadProgress {
+        let received = Int64(buffer.count)
+        let elapsed = now.timeIntervalSince(firstByteTime ?? startTime)
+        let speed = elapsed > 0 ? Double(received - Int64(resumedBytes)) / elapsed : 0
+        return DownloadProgress(
+            bytesDownloaded: received,
+            totalBytes: expectedBytes,
+            speed: speed,
+            timestamp: now
+        )
+    }
+}
@@ -0,0 +1,130 @@
+//
+//  NegativeCache.swift
+//  ImageDownloader
+//
+//  Bounded TTL cache of URLs known to fail
+//
+
+import Foundation
+
+/// Remembers URLs that cannot give an image, so they are not downloaded again on every scroll
+/// - `notFound` is remembered at once, decode failures after `decodeFailureThreshold` in a row
+/// - Entries expire after `ttl`, at most `capacity` URLs are kept (oldest dropped first)
+/// - Entries are linked in insertion order, so expiry and eviction unlink them in O(1)
+/// Not thread safe, access only from `NetworkAgent.isolationQueue`
+internal final class NegativeCache {
+    private final class Entry {
+        let key: String
+        let error: ImageDownloaderError
+        let expiry: Date
+        /// Neighbour inserted earlier (weak, the list owns nodes through `next`)
+        weak var prev: Entry?
+        /// Neighbour inserted later
+        var next: Entry?
+
+        init(key: String, error: ImageDownloaderError, expiry: Date) {
+            self.key = key
+            self.error = error
+            self.expiry = expiry
+        }
+    }
+
+    private let ttl: TimeInterval
+    private let capacity: Int
+    private let decodeFailureThreshold = 2
+    private var entries: [String: Entry] = [:]
+    /// Oldest entry
+    private var head: Entry?
+    /// Newest entry
+    private var tail: Entry?
+    private var decodeFailures: [String: Int] = [:]
+
+    /// - Parameters:
+    ///   - ttl: Seconds a failure is remembered (0 = disabled)
+    ///   - capacity: Maximum number of URLs remembered
+    init(ttl: TimeInterval, capacity: Int = 500) {
+        self.ttl = ttl
+        self.capacity = max(capacity, 1)
+    }
+
+    var count: Int {
+        entries.count
+    }
+
+    /// Remembered failure of a URL, nil when it should be downloaded
+    func error(for urlKey: String, now: Date = Date()) -> ImageDownloaderError? {
+        guard let entry = entries[urlKey] else { return nil }
+        guard now < entry.expiry else {
+            remove(entry)
+            return nil
+        }
+        return entry.error
+    }
+
+    func recordNotFound(_ urlKey: String) {
+        insert(.notFound, for: urlKey)
+    }
+
+    func recordDecodeFailure(_ urlKey: String) {
+        let failures = (decodeFailures[urlKey] ?? 0) + 1
+        if failures >= decodeFailureThreshold {
+            decodeFailures.removeValue(forKey: urlKey)
+            insert(.decodingFailed, for: urlKey)
+        } else {
+            if decodeFailures.count >= capacity {
+                decodeFailures.removeAll()
+            }
+            decodeFailures[urlKey] = failures
+        }
+    }
+
+    func recordSuccess(_ urlKey: String) {
+        decodeFailures.removeValue(forKey: urlKey)
+    }
+
+    func removeAll() {
+        // Unlinked one by one, so a long chain is not released recursively
+        while let entry = head {
+            remove(entry)
+        }
+        decodeFailures.removeAll()
+    }
+
+    // MARK: - Private
+
+    private func insert(_ error: ImageDownloaderError, for urlKey: String) {
+        guard ttl > 0 else { return }
+
+        if let existing = entries[urlKey] {
+            remove(existing)
+        }
+        let entry = Entry(key: urlKey, error: error, expiry: Date().addingTimeInterval(ttl))
+        entries[urlKey] = entry
+        entry.prev = tail
+        tail?.next = entry
+        tail = entry
+        if head == nil {
+            head = entry
+        }
+
+        while entries.count > capacity, let oldest = head {
+            remove(oldest)
+        }
+    }
+
+    private func remove(_ entry: Entry) {
+        entries.removeValue(forKey: entry.key)
+        if let prev = entry.prev {
+            prev.next = entry.next
+        } else {
+            head = entry.next
+        }
+        if let next = entry.next {
+            next.prev = entry.prev
+        } else {
+            tail = entry.prev
+        }
+        entry.prev = nil
+        entry.next = nil
+    }
+}
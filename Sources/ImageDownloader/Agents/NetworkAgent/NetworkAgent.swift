@@ -14,6 +14,11 @@ import UIKit
 typealias DownloadCompletionHandler = (UIImage?, Error?) -> Void
 typealias InternalDownloadCompletionHandler = (Data?, Error?) -> Void
 typealias DownloadProgressHandler = (DownloadProgress) -> Void
+typealias DownloadPartialImageHandler = (UIImage) -> Void
+/// Validated HTTP response and the body size (0 for 304)
+typealias DownloadResponseHandler = (HTTPURLResponse, Int64) -> Void
+/// Downloaded body, before it is decoded
+typealias DownloadDataHandler = (Data) -> Void
 
 /// NetworkAgent handles data downloads with automatic concurrency limiting and request deduplication
 /// Thread-safe using serial DispatchQueue
@@ -22,6 +27,10 @@ final class NetworkAgent: NSObject {
 
     // MARK: - Shared Resources
 
+    /// URLProtocol classes tried before the system ones (tests stub the network with it)
+    /// Read once when the shared session is created, set it before the first download
+    static var protocolClasses: [AnyClass] = []
+
     /// Shared URLSession instance used by all NetworkAgent instances
     private static let sharedSession: URLSession = {
         let config = URLSessionConfiguration.default
@@ -29,8 +38,10 @@ final class NetworkAgent: NSObject {
         config.isDiscretionary = false
         config.timeoutIntervalForRequest = 30
         config.timeoutIntervalForResource = 300
-        config.httpMaximumConnectionsPerHost = 6
+        // Per host limit is enforced by each agent (`maxConcurrentDownloadsPerHost`), keep the session out of the way
+        config.httpMaximumConnectionsPerHost = 16
         config.allowsCellularAccess = true
+        config.protocolClasses = protocolClasses + (config.protocolClasses ?? [])
 
         return URLSession(configuration: config, delegate: SessionDelegate.shared, delegateQueue: nil)
     }()
@@ -38,11 +49,17 @@ final class NetworkAgent: NSObject {
     // MARK: - Configuration Properties
 
     private var maxConcurrentDownloads: Int
+    private var maxConcurrentDownloadsPerHost: Int
     private var timeout: TimeInterval
     private var retryPolicy: RetryPolicy
     private var customHeaders: [String: String]?
     private var authenticationHandler: ((inout URLRequest) -> Void)?
     private var allowsCellularAccess: Bool
+    private var progressInterval: TimeInterval
+    private var progressiveDecodingInterval: TimeInterval
+    private var pendingRequestTimeout: TimeInterval
+    private var maxPendingDownloads: Int
+    private var pendingOverflowPolicy: IDQueueOverflowPolicy
 
     // MARK: - Thread Safety
 
@@ -54,29 +71,109 @@ final class NetworkAgent: NSObject {
     /// Active downloads: URL -> DownloadTask
     private var activeDownloads: [String: DownloadTask] = [:]
 
-    /// Pending downloads waiting for slot (FIFO queue with priority)
-    private var pendingQueue: [PendingDownloadRequest] = []
+    /// Number of active downloads per host: host -> count
+    private var activeCountByHost: [String: Int] = [:]
+
+    /// Adaptive concurrency window, nil when `maxConcurrentDownloads` is used as a fixed limit
+    private let concurrencyLimiter: AdaptiveConcurrencyLimiter?
+
+    /// Conditional requests answered with 304 and the body bytes they did not download
+    private var notModifiedCount = 0
+    private var notModifiedBytesSaved: Int64 = 0
+
+    /// Fails requests to hosts that keep failing without touching the network
+    private let circuitBreaker: CircuitBreaker
+
+    /// URLs known to give no image (404, repeated decode failures)
+    private let negativeCache: NegativeCache
+
+    /// Caps retries to a fraction of downloads across every host
+    private let retryBudget: RetryBudget
+
+    /// Body prefixes of interrupted downloads, resumed with range requests
+    private let partialDownloads: PartialDownloadStore
+
+    /// Hedge delay and budget, nil when hedging is disabled
+    private let hedgingPolicy: HedgingPolicy?
+
+    /// Decode stage of finished downloads, shared by every agent unless injected
+    private let decodeQueue: DecodeQueue
+
+    /// Pending downloads waiting for slot (heap by priority with aging, FIFO within priority)
+    private let pendingQueue: PendingQueue
+
+    /// One-shot timer failing queued requests at the earliest deadline, created on first use
+    private var expiryTimer: DispatchSourceTimer?
+    /// Deadline the expiry timer is armed for, nil when idle
+    private var expiryTimerDeadline: Date?
 
     // MARK: - Initialization
 
-    init(config: NetworkConfig) {
+    init(config: NetworkConfig, decodeQueue: DecodeQueue = .shared) {
+        self.decodeQueue = decodeQueue
         self.maxConcurrentDownloads = config.maxConcurrentDownloads
+        self.maxConcurrentDownloadsPerHost = config.maxConcurrentDownloadsPerHost
         self.timeout = config.timeout
         self.retryPolicy = config.retryPolicy
         self.customHeaders = config.customHeaders
         self.authenticationHandler = config.authenticationHandler
         self.allowsCellularAccess = config.allowsCellularAccess
+        self.progressInterval = config.progressInterval
+        self.progressiveDecodingInterval = config.progressiveDecodingInterval
+        self.pendingRequestTimeout = config.pendingRequestTimeout
+        self.maxPendingDownloads = config.maxPendingDownloads
+        self.pendingOverflowPolicy = config.pendingOverflowPolicy
+        self.pendingQueue = PendingQueue(agingInterval: config.priorityAgingInterval)
+        self.partialDownloads = PartialDownloadStore(memoryLimit: config.partialDownloadsMemoryLimit)
+        self.retryBudget = RetryBudget(ratio: config.retryBudgetRatio)
+        self.circuitBreaker = CircuitBreaker(
+            failureThreshold: config.circuitBreakerFailureThreshold,
+            openInterval: config.circuitBreakerOpenInterval
+        )
+        self.negativeCache = NegativeCache(ttl: config.negativeCacheTTL)
+        self.hedgingPolicy = config.hedgingEnabled
+            ? HedgingPolicy(percentile: config.hedgePercentile, budgetRatio: config.hedgeBudgetRatio)
+            : nil
+        if config.adaptiveConcurrency {
+            self.concurrencyLimiter = AdaptiveConcurrencyLimiter(
+                initialLimit: config.maxConcurrentDownloads,
+                minLimit: config.minAdaptiveConcurrentDownloads,
+                maxLimit: config.maxAdaptiveConcurrentDownloads
+            )
+        } else {
+            self.concurrencyLimiter = nil
+        }
         super.init()
     }
 
+    deinit {
+        expiryTimer?.cancel()
+    }
+
     // MARK: - Downloader agent api
     /// Download data with priority (ObjC compatible)
+    /// - Parameters:
+    ///   - validators: Validators of a stored copy, makes the request conditional. A 304 answer
+    ///     completes with `ResourceNotModified` as error and nothing is decoded
+    ///   - response: Called with the validated HTTP response before completion
+    ///   - data: Called with the downloaded body when decoding starts, so it can be persisted
+    ///     while it is decoded. Must return quickly, dispatch any I/O
+    ///   - deadline: Latest date the download may still be waiting for a slot, failed with `.timeout`
+    ///     after it (nil = `pendingRequestTimeout` after being queued). A started download is not affected
+    /// - Returns: Handle cancelling this caller only, see `cancelDownload(_:)`
+    @discardableResult
     func downloadData(
         at url: URL,
         priority: DownloadPriority = .high,
+        validators: ResourceValidators? = nil,
         progress: DownloadProgressHandler? = nil,
+        partialImage: DownloadPartialImageHandler? = nil,
+        response: DownloadResponseHandler? = nil,
+        data: DownloadDataHandler? = nil,
+        deadline: Date? = nil,
         completion: @escaping DownloadCompletionHandler
-    ) {
+    ) -> DownloadToken {
+        let token = DownloadToken(url: url)
         isolationQueue.async { [weak self] in
             guard let self = self else {
                 completion(nil, ImageDownloaderError.unknown(
@@ -87,52 +184,102 @@ final class NetworkAgent: NSObject {
 
             let urlKey = url.absoluteString
 
+            // FAIL FAST: known bad URL, or host currently unavailable
+            if let knownError = self.negativeCache.error(for: urlKey) {
+                completion(nil, knownError)
+                return
+            }
+            if self.circuitBreaker.isOpen(url.host ?? "") {
+                completion(nil, Self.hostUnavailableError(url))
+                return
+            }
+
             // REQUEST DEDUPLICATION: Check if already downloading
-            if let existingTask = self.activeDownloads[urlKey] {
-                // Join existing download - decode will happen when data arrives
+            if let existingTask = self.activeDownloads[urlKey], Self.canJoin(existingTask, validators: validators) {
+                // Join existing download - the image decoded once for the task is shared
                 existingTask.addWaiter(
-                    completion: { data, error in
-                        // Decode image
-                        guard let imageData = data,
-                              let image = ImageDecoder.decodeImage(from: imageData) else {
-                            completion(nil, error)
-                            return
-                        }
-                        completion(image, error)
-                    },
-                    progress: progress)
+                    token: token,
+                    completion: completion,
+                    progress: progress,
+                    partialImage: partialImage,
+                    response: response,
+                    data: data
+                )
+                // Priority inheritance: a more urgent joiner speeds up the shared download
+                if priority.isHigher(than: existingTask.priority) {
+                    existingTask.priority = priority
+                }
                 return
             }
 
-            // CONCURRENCY LIMITING: Check if we have available slots
-            if self.activeDownloads.count >= self.maxConcurrentDownloads {
+            // CONCURRENCY LIMITING: Check if we have available slots, globally and for the host
+            // (a conditional download of the same URL it cannot join is waited for)
+            if self.activeDownloads.count >= self.concurrencyLimitUnsafe
+                || !self.hasHostSlotUnsafe(url.host ?? "")
+                || self.activeDownloads[urlKey] != nil {
                 // Queue is full - add to pending queue
                 let pending = PendingDownloadRequest(
                     url: url,
+                    token: token,
                     priority: priority,
                     progress: progress,
-                    completion: completion
+                    partialImage: partialImage,
+                    response: response,
+                    data: data,
+                    validators: validators,
+                    completion: completion,
+                    deadline: deadline ?? Date(timeIntervalSinceNow: self.pendingRequestTimeout)
                 )
+                guard self.makeRoomUnsafe(for: pending) else { return }
+                self.pendingQueue.enqueue(pending)
+                self.scheduleExpirySweepUnsafe()
+                return
+            }
 
-                // Insert based on priority
-                if priority == .high {
-                    if let index = self.pendingQueue.firstIndex(where: { $0.priority == .low }) {
-                        self.pendingQueue.insert(pending, at: index)
-                    } else {
-                        self.pendingQueue.append(pending)
-                    }
-                } else {
-                    self.pendingQueue.append(pending)
+            // Start new download
+            self.startDownloadUnsafe(
+                url: url,
+                token: token,
+                priority: priority,
+                validators: validators,
+                progress: progress,
+                partialImage: partialImage,
+                response: response,
+                data: data,
+                completion: completion
+            )
+        }
+        return token
+    }
+
+    /// Cancel one caller of a download, completed with `.cancelled`
+    /// Other callers of the same URL keep waiting, the download itself is only cancelled
+    /// (and its slot released) when no caller is left
+    func cancelDownload(_ token: DownloadToken) {
+        isolationQueue.async { [weak self] in
+            guard let self = self else { return }
+
+            let urlKey = token.url.absoluteString
+
+            // Waiter of an active download
+            if let task = self.activeDownloads[urlKey], let removed = task.removeWaiter(token) {
+                removed.completion(nil, ImageDownloaderError.cancelled)
+                if removed.remaining == 0 {
+                    task.cancel()
+                    self.removeActiveUnsafe(task)
+                    self.processNextPendingUnsafe()
                 }
                 return
             }
 
-            // Start new download
-            self.startDownloadUnsafe(url: url, priority: priority, progress: progress, completion: completion)
+            // Still queued
+            if let pending = self.pendingQueue.removeRequest(for: token) {
+                pending.completion(nil, ImageDownloaderError.cancelled)
+            }
         }
     }
 
-    /// Cancel download for specific URL (ObjC compatible)
+    /// Cancel download for specific URL, for every caller (ObjC compatible)
     func cancelDownload(for url: URL) {
         isolationQueue.async { [weak self] in
             guard let self = self else { return }
@@ -142,7 +289,7 @@ final class NetworkAgent: NSObject {
             // Cancel active download
             if let task = self.activeDownloads[urlKey] {
                 task.cancel()
-                self.activeDownloads.removeValue(forKey: urlKey)
+                self.removeActiveUnsafe(task)
 
                 // Notify all waiters
                 let error = ImageDownloaderError.cancelled
@@ -154,13 +301,36 @@ final class NetworkAgent: NSObject {
             }
 
             // Remove from pending queue
-            self.pendingQueue.removeAll { pending in
-                if pending.url.absoluteString == urlKey {
-                    pending.completion(nil, ImageDownloaderError.cancelled)
-                    return true
-                }
-                return false
+            for pending in self.pendingQueue.removeAll(for: urlKey) {
+                pending.completion(nil, ImageDownloaderError.cancelled)
+            }
+        }
+    }
+
+    /// Raise or lower priority of a URL that is already queued or downloading
+    /// Queued requests are re-heaped, a running download gets its URLSessionTask priority updated
+    func updatePriority(for url: URL, to priority: DownloadPriority) {
+        isolationQueue.async { [weak self] in
+            guard let self = self else { return }
+
+            let urlKey = url.absoluteString
+            if let task = self.activeDownloads[urlKey] {
+                task.priority = priority
+            }
+            self.pendingQueue.updatePriority(for: urlKey, to: priority)
+        }
+    }
+
+    /// Move the queue deadline of a URL that is waiting for a slot
+    /// - Parameter deadline: New deadline, nil = `pendingRequestTimeout` after being queued
+    func updateDeadline(for url: URL, to deadline: Date?) {
+        isolationQueue.async { [weak self] in
+            guard let self = self else { return }
+
+            self.pendingQueue.updateDeadline(for: url.absoluteString) { pending in
+                deadline ?? pending.enqueueTime.addingTimeInterval(self.pendingRequestTimeout)
             }
+            self.scheduleExpirySweepUnsafe()
         }
     }
 
@@ -182,31 +352,247 @@ final class NetworkAgent: NSObject {
         return count
     }
 
+    /// Active downloads of one host
+    func activeDownloadCount(forHost host: String) -> Int {
+        var count = 0
+        isolationQueue.sync {
+            count = activeCountByHost[host] ?? 0
+        }
+        return count
+    }
+
+    /// Queued downloads of one host
+    func pendingDownloadCount(forHost host: String) -> Int {
+        var count = 0
+        isolationQueue.sync {
+            count = pendingQueue.count(forHost: host)
+        }
+        return count
+    }
+
+    /// Active and queued downloads of every host with work
+    var downloadCountsByHost: [String: (active: Int, pending: Int)] {
+        var counts: [String: (active: Int, pending: Int)] = [:]
+        isolationQueue.sync {
+            for (host, active) in activeCountByHost {
+                counts[host] = (active, 0)
+            }
+            for (host, pending) in pendingQueue.countsByHost {
+                counts[host] = (counts[host]?.active ?? 0, pending)
+            }
+        }
+        return counts
+    }
+
+    /// Conditional requests answered with 304 Not Modified
+    var revalidatedCount: Int {
+        var count = 0
+        isolationQueue.sync {
+            count = notModifiedCount
+        }
+        return count
+    }
+
+    /// Body bytes not downloaded thanks to 304 Not Modified answers
+    var revalidationBytesSaved: Int64 {
+        var bytes: Int64 = 0
+        isolationQueue.sync {
+            bytes = notModifiedBytesSaved
+        }
+        return bytes
+    }
+
+    /// Retries allowed and denied by the retry budget
+    var retryCounts: (allowed: Int, denied: Int) {
+        retryBudget.counts
+    }
+
+    /// Hedge requests sent and hedges that finished before the original request
+    var hedgeCounts: (issued: Int, wins: Int) {
+        hedgingPolicy?.counts ?? (0, 0)
+    }
+
+    /// Hosts whose circuit is open or half-open
+    var unavailableHosts: [String] {
+        var hosts: [String] = []
+        isolationQueue.sync {
+            hosts = circuitBreaker.unavailableHosts
+        }
+        return hosts
+    }
+
+    /// URLs currently failing fast from the negative cache
+    var negativeCacheCount: Int {
+        var count = 0
+        isolationQueue.sync {
+            count = negativeCache.count
+        }
+        return count
+    }
+
+    /// Current concurrency window (fixed `maxConcurrentDownloads` when adaptive concurrency is off)
+    var currentConcurrencyLimit: Int {
+        var limit = 0
+        isolationQueue.sync {
+            limit = concurrencyLimitUnsafe
+        }
+        return limit
+    }
+
     // MARK: - Private Methods (Must be called on isolationQueue)
 
+    private var concurrencyLimitUnsafe: Int {
+        concurrencyLimiter?.currentLimit ?? maxConcurrentDownloads
+    }
+
+    /// Slots one host may use, half of the current window unless configured (0 = unlimited)
+    private var hostSlotLimitUnsafe: Int {
+        maxConcurrentDownloadsPerHost < 0 ? max(1, concurrencyLimitUnsafe / 2) : maxConcurrentDownloadsPerHost
+    }
+
+    /// Whether a host is below its slot limit
+    private func hasHostSlotUnsafe(_ host: String) -> Bool {
+        let limit = hostSlotLimitUnsafe
+        return limit == 0 || (activeCountByHost[host] ?? 0) < limit
+    }
+
+    /// Make room in a full pending queue according to `pendingOverflowPolicy`
+    /// - Returns: false when the new request was rejected (and already completed)
+    private func makeRoomUnsafe(for request: PendingDownloadRequest) -> Bool {
+        guard maxPendingDownloads > 0, pendingQueue.count >= maxPendingDownloads else { return true }
+
+        if pendingOverflowPolicy == .dropOldestLowPriority,
+           let victim = pendingQueue.oldestLowestPriorityRequest(),
+           !victim.priority.isHigher(than: request.priority) {
+            pendingQueue.remove(victim)
+            victim.completion(nil, Self.queueFullError(victim.url))
+            return true
+        }
+
+        request.completion(nil, Self.queueFullError(request.url))
+        return false
+    }
+
+    /// Arm the expiry timer for the earliest queued deadline, if it is not armed earlier already
+    private func scheduleExpirySweepUnsafe() {
+        guard let earliest = pendingQueue.earliestDeadline else { return }
+        if let armed = expiryTimerDeadline, armed <= earliest { return }
+
+        let timer: DispatchSourceTimer
+        if let existing = expiryTimer {
+            timer = existing
+        } else {
+            timer = DispatchSource.makeTimerSource(queue: isolationQueue)
+            timer.setEventHandler { [weak self] in
+                self?.sweepExpiredUnsafe()
+            }
+            timer.resume()
+            expiryTimer = timer
+        }
+        timer.schedule(deadline: .now() + max(earliest.timeIntervalSinceNow, 0), leeway: .milliseconds(50))
+        expiryTimerDeadline = earliest
+    }
+
+    /// Fail every queued request past its deadline, then re-arm for the next one
+    private func sweepExpiredUnsafe() {
+        expiryTimerDeadline = nil
+        for pending in pendingQueue.removeExpired() {
+            pending.completion(nil, ImageDownloaderError.timeout)
+        }
+        scheduleExpirySweepUnsafe()
+    }
+
+    /// Drop an active download and release its host slot
+    /// No-op when the task is no longer the active one (cancelled and replaced meanwhile)
+    private func removeActiveUnsafe(_ task: DownloadTask) {
+        let urlKey = task.url.absoluteString
+        guard activeDownloads[urlKey] === task else { return }
+        activeDownloads.removeValue(forKey: urlKey)
+        let host = task.url.host ?? ""
+        let remaining = (activeCountByHost[host] ?? 1) - 1
+        activeCountByHost[host] = remaining > 0 ? remaining : nil
+    }
+
+    /// Feed a finished download to the circuit breaker, negative cache and adaptive limiter
+    /// (must be called on isolationQueue)
+    private func recordOutcomeUnsafe(task: DownloadTask, data: Data?, error: Error?, inFlight: Int) {
+        let host = task.url.host ?? ""
+        if let error = error {
+            if Self.isHostFailure(error) {
+                circuitBreaker.recordFailure(host)
+            } else if case .notFound? = error as? ImageDownloaderError {
+                circuitBreaker.recordSuccess(host)
+                negativeCache.recordNotFound(task.url.absoluteString)
+            } else if error is ResourceNotModified {
+                circuitBreaker.recordSuccess(host)
+            } else {
+                circuitBreaker.recordNeutral(host)
+            }
+        } else {
+            circuitBreaker.recordSuccess(host)
+        }
+
+        guard let limiter = concurrencyLimiter else { return }
+
+        if let error = error {
+            switch error as? ImageDownloaderError {
+            case .timeout?, .networkError?:
+                limiter.recordFailure()
+            default:
+                break
+            }
+            return
+        }
+
+        let duration = Date().timeIntervalSince(task.startTime)
+        limiter.recordSuccess(
+            latency: task.timeToFirstByte ?? duration,
+            bytes: Int64(data?.count ?? 0),
+            duration: duration,
+            inFlight: inFlight
+        )
+    }
+
     /// Start a new download (must be called on isolationQueue)
     private func startDownloadUnsafe(
         url: URL,
+        token: DownloadToken,
         priority: DownloadPriority,
+        validators: ResourceValidators?,
         progress: DownloadProgressHandler?,
+        partialImage: DownloadPartialImageHandler?,
+        response: DownloadResponseHandler?,
+        data: DownloadDataHandler?,
         completion: @escaping DownloadCompletionHandler
     ) {
         let urlKey = url.absoluteString
+
+        // Open circuit, or a half-open probe is already checking the host
+        guard circuitBreaker.acquire(url.host ?? "") else {
+            completion(nil, Self.hostUnavailableError(url))
+            return
+        }
         
         // Create download task
-        let downloadTask = DownloadTask(url: url, priority: priority)
+        let downloadTask = DownloadTask(
+            url: url,
+            priority: priority,
+            validators: validators,
+            progressiveInterval: progressiveDecodingInterval,
+            decodeQueue: decodeQueue
+        )
         downloadTask.addWaiter(
-            completion: { data, error in
-                // Decode image
-                guard let imageData = data,
-                      let image = ImageDecoder.decodeImage(from: imageData) else {
-                    completion(nil, error)
-                    return
-                }
-                completion(image, error)
-            },
-            progress: progress)
+            token: token,
+            completion: completion,
+            progress: progress,
+            partialImage: partialImage,
+            response: response,
+            data: data
+        )
         activeDownloads[urlKey] = downloadTask
+        activeCountByHost[url.host ?? "", default: 0] += 1
+        retryBudget.recordRequest()
+        hedgingPolicy?.recordRequest()
         
         // Perform download on background queue
         DispatchQueue.global(qos: .userInitiated).async { [weak self] in
@@ -215,14 +601,25 @@ final class NetworkAgent: NSObject {
             self.performDownload(
                 url: url,
                 retryAttempt: 0,
+                previousDelay: 0,
                 task: downloadTask
             ) { data, error in
                 // Handle completion on isolation queue
                 self.isolationQueue.async {
-                    self.activeDownloads.removeValue(forKey: urlKey)
-
-                    // Notify all waiters
-                    downloadTask.notifyAllWaiters(data: data, error: error)
+                    self.recordOutcomeUnsafe(task: downloadTask, data: data, error: error, inFlight: self.activeDownloads.count)
+                    self.removeActiveUnsafe(downloadTask)
+
+                    // Hand off to decode stage, isolation queue only does bookkeeping
+                    downloadTask.notifyAllWaiters(data: data, error: error) { [weak self] image in
+                        guard let self = self else { return }
+                        self.isolationQueue.async {
+                            if image == nil {
+                                self.negativeCache.recordDecodeFailure(urlKey)
+                            } else {
+                                self.negativeCache.recordSuccess(urlKey)
+                            }
+                        }
+                    }
 
                     // Process next pending download
                     self.processNextPendingUnsafe()
@@ -233,34 +630,67 @@ final class NetworkAgent: NSObject {
 
     /// Process next pending download if slot available (must be called on isolationQueue)
     private func processNextPendingUnsafe() {
-        guard activeDownloads.count < maxConcurrentDownloads,
-              !pendingQueue.isEmpty else {
-            return
-        }
+        // Waiting for a conditional download of their URL, queued again once the loop is done
+        var deferred: [PendingDownloadRequest] = []
+        defer { deferred.forEach(pendingQueue.enqueue) }
 
-        let pending = pendingQueue.removeFirst()
+        // Fair across hosts: only hosts with a free slot are served, round-robin among equals
+        while activeDownloads.count < concurrencyLimitUnsafe,
+              let pending = pendingQueue.dequeue(where: { hasHostSlotUnsafe($0) }) {
 
-        if pending.isExpired {
-            pending.completion(nil, ImageDownloaderError.timeout)
-            processNextPendingUnsafe()
-            return
-        }
+            if pending.isExpired {
+                pending.completion(nil, ImageDownloaderError.timeout)
+                continue
+            }
 
-        startDownloadUnsafe(
-            url: pending.url,
-            priority: pending.priority,
-            progress: pending.progress,
-            completion: pending.completion
-        )
+            // Same URL started meanwhile - join it instead of downloading twice
+            if let existingTask = activeDownloads[pending.url.absoluteString] {
+                guard Self.canJoin(existingTask, validators: pending.validators) else {
+                    deferred.append(pending)
+                    continue
+                }
+                existingTask.addWaiter(
+                    token: pending.token,
+                    completion: pending.completion,
+                    progress: pending.progress,
+                    partialImage: pending.partialImage,
+                    response: pending.response,
+                    data: pending.data
+                )
+                if pending.priority.isHigher(than: existingTask.priority) {
+                    existingTask.priority = pending.priority
+                }
+                continue
+            }
+
+            startDownloadUnsafe(
+                url: pending.url,
+                token: pending.token,
+                priority: pending.priority,
+                validators: pending.validators,
+                progress: pending.progress,
+                partialImage: pending.partialImage,
+                response: pending.response,
+                data: pending.data,
+                completion: pending.completion
+            )
+        }
     }
 
     /// Perform the actual download with retry logic
     private func performDownload(
         url: URL,
         retryAttempt: Int,
+        previousDelay: TimeInterval,
         task: DownloadTask,
         completion: @escaping InternalDownloadCompletionHandler
     ) {
+        // Cancelled while waiting for a retry
+        if task.isCancelled {
+            completion(nil, ImageDownloaderError.cancelled)
+            return
+        }
+
         // Build request
         var request = URLRequest(url: url)
         request.timeoutInterval = timeout
@@ -274,13 +704,21 @@ final class NetworkAgent: NSObject {
             }
         }
 
+        // Conditional request, the stored copy is kept on 304
+        task.validators?.apply(to: &request)
+
+        // Resume an interrupted body (not for conditional requests, a 304 has no body to append to)
+        let urlKey = url.absoluteString
+        let resumeFrom = task.validators == nil ? partialDownloads.take(for: urlKey) : nil
+        resumeFrom?.apply(to: &request)
+
         // Apply authentication handler
         authenticationHandler?(&request)
 
         let startTime = Date()
 
-        // Create URLSession task
-        let urlSessionTask = Self.sharedSession.dataTask(with: request) { [weak self] data, response, error in
+        // Outcome of the attempt, from whichever request won when hedged
+        let handleResult: StreamingDownload.Completion = { [weak self] data, response, error in
             guard let self = self else {
                 completion(nil, ImageDownloaderError.unknown(
                     NSError(domain: "NetworkAgent", code: -1, userInfo: nil)
@@ -291,13 +729,15 @@ final class NetworkAgent: NSObject {
             // Handle error
             if let error = error {
                 // Check if should retry
-                if self.retryPolicy.shouldRetry(for: error, attempt: retryAttempt, url: url) {
-                    let delay = self.retryPolicy.delay(forAttempt: retryAttempt + 1)
-
-                    // Retry after delay
-                    DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) {
-                        self.performDownload(url: url, retryAttempt: retryAttempt + 1, task: task, completion: completion)
-                    }
+                if self.retryPolicy.shouldRetry(for: error, attempt: retryAttempt, url: url),
+                   self.scheduleRetry(
+                    url: url,
+                    retryAttempt: retryAttempt,
+                    previousDelay: previousDelay,
+                    retryAfter: nil,
+                    task: task,
+                    completion: completion
+                   ) {
                     return
                 }
 
@@ -315,16 +755,42 @@ final class NetworkAgent: NSObject {
                 return
             }
 
+            // Stored copy is still valid, no body to decode
+            if httpResponse.statusCode == 304, let validators = task.validators {
+                self.isolationQueue.async {
+                    self.notModifiedCount += 1
+                    self.notModifiedBytesSaved += validators.contentLength
+                }
+                task.notifyResponse(httpResponse, bodyLength: 0)
+                completion(nil, ResourceNotModified(response: httpResponse))
+                return
+            }
+
             // Check status code
             guard (200...299).contains(httpResponse.statusCode) else {
                 if httpResponse.statusCode == 404 {
                     completion(nil, ImageDownloaderError.notFound)
-                } else {
-                    completion(nil, ImageDownloaderError.networkError(
-                        NSError(domain: NSURLErrorDomain, code: httpResponse.statusCode,
-                                userInfo: [NSLocalizedDescriptionKey: "HTTP \(httpResponse.statusCode)"])
-                    ))
+                    return
                 }
+
+                // 5xx / 429 / 408: retry, waiting at least what Retry-After asks
+                if self.retryPolicy.shouldRetry(statusCode: httpResponse.statusCode, attempt: retryAttempt, url: url),
+                   self.scheduleRetry(
+                    url: url,
+                    retryAttempt: retryAttempt,
+                    previousDelay: previousDelay,
+                    retryAfter: RetryPolicy.retryAfter(from: httpResponse),
+                    task: task,
+                    completion: completion
+                   ) {
+                    return
+                }
+
+                completion(nil, ImageDownloaderError.networkError(
+                    NSError(domain: NSURLErrorDomain, code: httpResponse.statusCode,
+                            userInfo: [NSLocalizedDescriptionKey: "HTTP \(httpResponse.statusCode)",
+                                       RetryPolicy.httpResponseUserInfoKey: httpResponse])
+                ))
                 return
             }
 
@@ -337,6 +803,8 @@ final class NetworkAgent: NSObject {
                 return
             }
 
+            task.notifyResponse(httpResponse, bodyLength: Int64(data.count))
+
             // Report final progress
             let totalBytes = Int64(data.count)
             let totalTime = Date().timeIntervalSince(startTime)
@@ -348,18 +816,200 @@ final class NetworkAgent: NSObject {
                 speed: avgSpeed
             )
 
-            DispatchQueue.main.async {
-                task.notifyProgress(finalProgress)
-            }
+            task.notifyProgress(finalProgress)
 
             completion(data, nil)
         }
 
+        let attempt = HedgedAttempt(completion: handleResult) { [weak self] in
+            self?.hedgingPolicy?.recordWin()
+        }
+        guard let urlSessionTask = makeSessionTask(
+            request,
+            urlKey: urlKey,
+            task: task,
+            attempt: attempt,
+            isHedge: false,
+            resumeFrom: resumeFrom
+        ) else { return }
+
         // Store task for cancellation
         task.urlSessionTask = urlSessionTask
+        task.hedgeSessionTask = nil
 
         // Start download
         urlSessionTask.resume()
+        // Cancelled between the check above and storing the task
+        if task.isCancelled {
+            urlSessionTask.cancel()
+            return
+        }
+
+        scheduleHedge(request, urlKey: urlKey, task: task, attempt: attempt, resumeFrom: resumeFrom)
+    }
+
+    /// Create one request of an attempt, its body streams through SessionDelegate
+    /// Only the request that received the first byte reports progress and partial data
+    /// - Returns: The task to resume, nil when the attempt already finished
+    private func makeSessionTask(
+        _ request: URLRequest,
+        urlKey: String,
+        task: DownloadTask,
+        attempt: HedgedAttempt,
+        isHedge: Bool,
+        resumeFrom: PartialDownload?
+    ) -> URLSessionDataTask? {
+        let urlSessionTask = Self.sharedSession.dataTask(with: request)
+        guard attempt.add(urlSessionTask, isHedge: isHedge) else { return nil }
+        let identifier = urlSessionTask.taskIdentifier
+
+        let streamingDownload = StreamingDownload(
+            progressInterval: progressInterval,
+            onProgress: { progress in
+                if attempt.isLeading(identifier) {
+                    task.notifyProgress(progress)
+                }
+            },
+            onFirstByte: { [weak self] latency in
+                // Hedges answer late by design, only primary requests feed the delay percentile
+                if !isHedge {
+                    self?.hedgingPolicy?.recordFirstByte(latency)
+                }
+                if attempt.claimFirstByte(identifier) {
+                    task.timeToFirstByte = latency
+                }
+            },
+            onData: { received in
+                if attempt.isLeading(identifier) {
+                    task.receivedPartialData(received)
+                }
+            },
+            resumeFrom: resumeFrom,
+            onInterrupted: { [weak self] partial in
+                if !attempt.isFinished, attempt.isLeading(identifier) {
+                    self?.partialDownloads.store(partial, for: urlKey)
+                }
+            }
+        ) { data, response, error in
+            attempt.complete(identifier, data: data, response: response, error: error)
+        }
+        SessionDelegate.shared.register(streamingDownload, for: urlSessionTask)
+        return urlSessionTask
+    }
+
+    /// Send a second identical request when the attempt still has no first byte after the hedge delay
+    /// The first request to finish wins, the other one is cancelled
+    private func scheduleHedge(
+        _ request: URLRequest,
+        urlKey: String,
+        task: DownloadTask,
+        attempt: HedgedAttempt,
+        resumeFrom: PartialDownload?
+    ) {
+        guard let hedgingPolicy = hedgingPolicy, let delay = hedgingPolicy.hedgeDelay() else { return }
+
+        DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) { [weak self] in
+            guard let self = self,
+                  !attempt.isFinished,
+                  !attempt.hasFirstByte,
+                  !task.isCancelled,
+                  hedgingPolicy.tryAcquire(),
+                  let hedgeTask = self.makeSessionTask(
+                    request,
+                    urlKey: urlKey,
+                    task: task,
+                    attempt: attempt,
+                    isHedge: true,
+                    resumeFrom: resumeFrom
+                  ) else {
+                return
+            }
+
+            task.hedgeSessionTask = hedgeTask
+            hedgeTask.resume()
+            // Cancelled while the hedge was being created
+            if task.isCancelled {
+                hedgeTask.cancel()
+            }
+        }
+    }
+
+    /// Whether a caller can share an active download
+    /// A conditional download answered 304 has no body: only callers holding the same stored copy
+    /// (same validators) can use its answer, an unconditional download suits everyone
+    private static func canJoin(_ task: DownloadTask, validators: ResourceValidators?) -> Bool {
+        guard let taskValidators = task.validators else { return true }
+        guard let validators = validators else { return false }
+        return taskValidators.hasSameConditions(as: validators)
+    }
+
+    /// Whether an error says the host is unreachable or failing (timeouts, connection errors, 5xx)
+    /// 4xx answers, cancellation and decode errors say nothing about the host health
+    private static func isHostFailure(_ error: Error) -> Bool {
+        switch error as? ImageDownloaderError {
+        case .timeout?:
+            return true
+        case .networkError(let underlying)?:
+            let nsError = underlying as NSError
+            if nsError.domain == hostUnavailableErrorDomain {
+                return false
+            }
+            if let httpResponse = nsError.userInfo[RetryPolicy.httpResponseUserInfoKey] as? HTTPURLResponse {
+                return httpResponse.statusCode >= 500
+            }
+            return true
+        default:
+            return false
+        }
+    }
+
+    private static let hostUnavailableErrorDomain = "ImageDownloader.CircuitBreaker"
+
+    private static let queueFullErrorDomain = "ImageDownloader.PendingQueue"
+
+    /// Error of a request rejected or dropped because the pending queue is full
+    private static func queueFullError(_ url: URL) -> ImageDownloaderError {
+        return .networkError(
+            NSError(domain: queueFullErrorDomain, code: NSURLErrorCancelled,
+                    userInfo: [NSLocalizedDescriptionKey: "Download queue is full, \(url.absoluteString) was not queued"])
+        )
+    }
+
+    /// Error of a request refused because the circuit of its host is open
+    private static func hostUnavailableError(_ url: URL) -> ImageDownloaderError {
+        return .networkError(
+            NSError(domain: hostUnavailableErrorDomain, code: NSURLErrorCannotConnectToHost,
+                    userInfo: [NSLocalizedDescriptionKey: "Host \(url.host ?? "") is unavailable, requests are paused"])
+        )
+    }
+
+    /// Schedule the next attempt with decorrelated jitter, if the retry budget allows it
+    /// - Returns: false when the failure must be reported instead: budget exhausted, or the
+    ///   server asked (Retry-After) to wait longer than `maxDelay`
+    private func scheduleRetry(
+        url: URL,
+        retryAttempt: Int,
+        previousDelay: TimeInterval,
+        retryAfter: TimeInterval?,
+        task: DownloadTask,
+        completion: @escaping InternalDownloadCompletionHandler
+    ) -> Bool {
+        if let retryAfter = retryAfter, retryAfter > retryPolicy.maxDelay {
+            return false
+        }
+        guard retryBudget.tryWithdraw() else { return false }
+
+        let delay = max(retryAfter ?? 0, retryPolicy.jitteredDelay(previousDelay: previousDelay))
+        DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) {
+            self.performDownload(
+                url: url,
+                retryAttempt: retryAttempt + 1,
+                previousDelay: delay,
+                task: task,
+                completion: completion
+            )
+        }
+        return true
     }
 
     /// Convert NSError to ImageDownloaderError
@@ -402,12 +1052,12 @@ final class NetworkAgent: NSObject {
                 task.notifyAllWaiters(data: nil, error: ImageDownloaderError.cancelled)
             }
             self.activeDownloads.removeAll()
+            self.activeCountByHost.removeAll()
 
             // Clear pending queue
-            for pending in self.pendingQueue {
+            for pending in self.pendingQueue.removeAll() {
                 pending.completion(nil, ImageDownloaderError.cancelled)
             }
-            self.pendingQueue.removeAll()
         }
     }
 }
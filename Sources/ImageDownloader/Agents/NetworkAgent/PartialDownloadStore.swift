@@ -0,0 +1,71 @@
+//
+//  PartialDownloadStore.swift
+//  ImageDownloader
+//
+//  Bounded in-memory store of interrupted download bodies
+//
+
+import Foundation
+
+/// Keeps body prefixes of interrupted downloads so a retry or a later request can resume them
+/// - Bounded by total bytes, the oldest prefixes are dropped first
+/// - Small prefixes are not kept, re-downloading them costs less than a range request round trip
+/// Thread safe
+internal final class PartialDownloadStore {
+    /// Prefixes shorter than this are not worth resuming
+    static let minimumResumableBytes = 64 * 1024
+
+    private let lock = NSLock()
+    private let memoryLimit: Int
+    private var partials: [String: PartialDownload] = [:]
+    /// Keys from oldest to newest
+    private var order: [String] = []
+    private var totalBytes = 0
+
+    /// - Parameter memoryLimit: Maximum bytes kept (0 = keep nothing)
+    init(memoryLimit: Int) {
+        self.memoryLimit = max(memoryLimit, 0)
+    }
+
+    /// Keep a prefix, replacing the previous one of the same URL
+    func store(_ partial: PartialDownload, for urlKey: String) {
+        let size = partial.data.count
+        guard size >= Self.minimumResumableBytes, size <= memoryLimit else { return }
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        removeUnsafe(urlKey)
+        while totalBytes + size > memoryLimit, let oldest = order.first {
+            removeUnsafe(oldest)
+        }
+        partials[urlKey] = partial
+        order.append(urlKey)
+        totalBytes += size
+    }
+
+    /// Remove and return the prefix of a URL, the caller owns it while resuming
+    func take(for urlKey: String) -> PartialDownload? {
+        lock.lock()
+        defer { lock.unlock() }
+        let partial = partials[urlKey]
+        removeUnsafe(urlKey)
+        return partial
+    }
+
+    func removeAll() {
+        lock.lock()
+        partials.removeAll()
+        order.removeAll()
+        totalBytes = 0
+        lock.unlock()
+    }
+
+    // MARK: - Private
+
+    private func removeUnsafe(_ urlKey: String) {
+        guard let removed = partials.removeValue(forKey: urlKey) else { return }
+        totalBytes -= removed.data.count
+        order.removeAll { $0 == urlKey }
+    }
+}
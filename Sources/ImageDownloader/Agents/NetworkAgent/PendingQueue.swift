@@ -0,0 +1,363 @@
+//
+//  PendingQueue.swift
+//  ImageDownloader
+//
+//  Per-host indexed binary-heap scheduler for downloads waiting for a slot
+//
+
+import Foundation
+
+/// Priority scheduler of NetworkAgent pending downloads
+/// - Served by `DownloadPriority`, FIFO within the same priority
+/// - Aging: a request is keyed by `enqueueTime + priority * agingInterval`, so waiting
+///   `agingInterval` seconds is worth one priority level and low priority work cannot starve
+///   (the key never changes once queued, so aging costs nothing per tick).
+///   An `agingInterval` of 0 turns aging off: strict priority order, FIFO within a priority
+/// - Deadlines: a request is never keyed later than one `agingInterval` before its deadline,
+///   so a request about to expire is served like a fresh high priority one
+/// - Fairness: every host has its own heap, hosts whose head is at the same (aged) priority
+///   level are served round-robin, so a host with a long backlog cannot take every slot
+/// - Expiry: a second heap orders requests by deadline, expired ones are removed without a scan
+/// - Enqueue, dequeue and cancel of one request are O(log n + hosts), the request is its own heap handle
+/// Not thread safe, access only from `NetworkAgent.isolationQueue`
+internal final class PendingQueue {
+    private var queuesByHost: [String: RequestHeap] = [:]
+    /// Every queued request, earliest deadline first
+    private let deadlines = RequestHeap(index: \.deadlineHeapIndex) { $0.deadline < $1.deadline }
+    /// Round-robin order of hosts that have queued requests
+    private var hostOrder: [String] = []
+    /// Position in `hostOrder` to start the next round-robin scan from
+    private var nextHostIndex = 0
+    private var requestsByURL: [String: [PendingDownloadRequest]] = [:]
+    private var nextSequence: UInt64 = 0
+    private let agingInterval: TimeInterval
+    private(set) var count = 0
+
+    /// - Parameter agingInterval: Seconds of waiting worth one priority level
+    init(agingInterval: TimeInterval) {
+        self.agingInterval = max(agingInterval, 0)
+    }
+
+    var isEmpty: Bool {
+        count == 0
+    }
+
+    /// Number of queued requests for a host
+    func count(forHost host: String) -> Int {
+        queuesByHost[host]?.heap.count ?? 0
+    }
+
+    /// Number of queued requests per host
+    var countsByHost: [String: Int] {
+        queuesByHost.mapValues { $0.heap.count }
+    }
+
+    func enqueue(_ request: PendingDownloadRequest) {
+        request.schedulingKey = schedulingKey(of: request)
+        request.sequence = nextSequence
+        nextSequence &+= 1
+
+        let host = request.host
+        let queue: RequestHeap
+        if let existing = queuesByHost[host] {
+            queue = existing
+        } else {
+            queue = RequestHeap(index: \.heapIndex) { [agingInterval] in
+                Self.isScheduledBefore($0, $1, agingInterval: agingInterval)
+            }
+            queuesByHost[host] = queue
+            hostOrder.append(host)
+        }
+        queue.insert(request)
+        deadlines.insert(request)
+        count += 1
+
+        requestsByURL[request.url.absoluteString, default: []].append(request)
+    }
+
+    /// Remove and return the request to serve next, regardless of host limits
+    func dequeue() -> PendingDownloadRequest? {
+        return dequeue(where: { _ in true })
+    }
+
+    /// Remove and return the request to serve next among hosts accepted by `canServe`
+    /// - Parameter canServe: Whether a host has a free slot
+    /// - Returns: Head of the most urgent eligible host, round-robin among equally urgent hosts
+    func dequeue(where canServe: (String) -> Bool) -> PendingDownloadRequest? {
+        guard !hostOrder.isEmpty else { return nil }
+
+        let now = Date().timeIntervalSinceReferenceDate
+        let hostCount = hostOrder.count
+        let start = nextHostIndex % hostCount
+
+        // Best aged priority level among eligible hosts
+        var bestLevel = Int.max
+        var eligible: [Int: Int] = [:]
+        for offset in 0..<hostCount {
+            let index = (start + offset) % hostCount
+            let host = hostOrder[index]
+            guard let head = queuesByHost[host]?.heap.first, canServe(host) else { continue }
+            let level = effectiveLevel(of: head, now: now)
+            eligible[index] = level
+            bestLevel = min(bestLevel, level)
+        }
+        guard bestLevel != Int.max else { return nil }
+
+        // First host at that level after the previously served one
+        for offset in 0..<hostCount {
+            let index = (start + offset) % hostCount
+            guard eligible[index] == bestLevel,
+                  let request = queuesByHost[hostOrder[index]]?.heap.first else { continue }
+            nextHostIndex = index + 1
+            remove(request)
+            return request
+        }
+        return nil
+    }
+
+    /// Remove a queued request, O(log n)
+    func remove(_ request: PendingDownloadRequest) {
+        let host = request.host
+        guard let queue = queuesByHost[host], queue.remove(request) else { return }
+        deadlines.remove(request)
+        count -= 1
+
+        if queue.heap.isEmpty {
+            queuesByHost.removeValue(forKey: host)
+            if let index = hostOrder.firstIndex(of: host) {
+                hostOrder.remove(at: index)
+                if index < nextHostIndex {
+                    nextHostIndex -= 1
+                }
+            }
+        }
+
+        let urlKey = request.url.absoluteString
+        if var sameURL = requestsByURL[urlKey] {
+            sameURL.removeAll { $0 === request }
+            requestsByURL[urlKey] = sameURL.isEmpty ? nil : sameURL
+        }
+    }
+
+    /// Remove the queued request of one caller
+    /// - Returns: The removed request, nil when the caller has nothing queued
+    func removeRequest(for token: DownloadToken) -> PendingDownloadRequest? {
+        guard let request = requestsByURL[token.url.absoluteString]?.first(where: { $0.token === token }) else {
+            return nil
+        }
+        remove(request)
+        return request
+    }
+
+    /// Change priority of every queued request for a URL and re-heap them, O(log n) each
+    /// Time already waited is kept, so aging still applies after the change
+    func updatePriority(for urlKey: String, to priority: DownloadPriority) {
+        guard let requests = requestsByURL[urlKey] else { return }
+        for request in requests {
+            guard let queue = queuesByHost[request.host] else { continue }
+            request.priority = priority
+            request.schedulingKey = schedulingKey(of: request)
+            queue.update(request)
+        }
+    }
+
+    /// Move the deadline of every queued request for a URL, O(log n) each
+    /// - Parameter deadline: New deadline of a queued request
+    func updateDeadline(for urlKey: String, to deadline: (PendingDownloadRequest) -> Date) {
+        guard let requests = requestsByURL[urlKey] else { return }
+        for request in requests {
+            guard let queue = queuesByHost[request.host] else { continue }
+            request.deadline = deadline(request)
+            request.schedulingKey = schedulingKey(of: request)
+            queue.update(request)
+            deadlines.update(request)
+        }
+    }
+
+    /// Earliest deadline of the queued requests, nil when empty
+    var earliestDeadline: Date? {
+        deadlines.heap.first?.deadline
+    }
+
+    /// Remove every request whose deadline passed, O(k log n) for k expired requests
+    func removeExpired(now: Date = Date()) -> [PendingDownloadRequest] {
+        var expired: [PendingDownloadRequest] = []
+        while let request = deadlines.heap.first, request.deadline <= now {
+            remove(request)
+            expired.append(request)
+        }
+        return expired
+    }
+
+    /// Oldest request of the lowest queued priority, the victim of `.dropOldestLowPriority`
+    /// O(n), only used when the queue is full
+    func oldestLowestPriorityRequest() -> PendingDownloadRequest? {
+        var victim: PendingDownloadRequest?
+        for queue in queuesByHost.values {
+            for request in queue.heap {
+                guard let current = victim else {
+                    victim = request
+                    continue
+                }
+                if current.priority.isHigher(than: request.priority)
+                    || (current.priority == request.priority && request.sequence < current.sequence) {
+                    victim = request
+                }
+            }
+        }
+        return victim
+    }
+
+    /// Remove every queued request for a URL
+    func removeAll(for urlKey: String) -> [PendingDownloadRequest] {
+        guard let requests = requestsByURL[urlKey] else { return [] }
+        for request in requests {
+            remove(request)
+        }
+        return requests
+    }
+
+    /// Remove every queued request
+    func removeAll() -> [PendingDownloadRequest] {
+        var requests: [PendingDownloadRequest] = []
+        requests.reserveCapacity(count)
+        for queue in queuesByHost.values {
+            for request in queue.heap {
+                request.heapIndex = nil
+                requests.append(request)
+            }
+        }
+        queuesByHost.removeAll()
+        deadlines.removeAll()
+        hostOrder.removeAll()
+        nextHostIndex = 0
+        requestsByURL.removeAll()
+        count = 0
+        return requests
+    }
+
+    // MARK: - Private
+
+    private func schedulingKey(of request: PendingDownloadRequest) -> TimeInterval {
+        let agedKey = request.enqueueTime.timeIntervalSinceReferenceDate + Double(request.priority.rank) * agingInterval
+        let deadlineKey = request.deadline.timeIntervalSinceReferenceDate - agingInterval
+        return min(agedKey, deadlineKey)
+    }
+
+    /// Order of a host heap: scheduling key, FIFO for equal keys
+    /// Without aging the key carries no priority (it is the enqueue time), so priority goes first
+    private static func isScheduledBefore(
+        _ lhs: PendingDownloadRequest,
+        _ rhs: PendingDownloadRequest,
+        agingInterval: TimeInterval
+    ) -> Bool {
+        if agingInterval == 0, lhs.priority != rhs.priority {
+            return lhs.priority.rank < rhs.priority.rank
+        }
+        if lhs.schedulingKey != rhs.schedulingKey {
+            return lhs.schedulingKey < rhs.schedulingKey
+        }
+        return lhs.sequence < rhs.sequence
+    }
+
+    /// Priority level after aging, smaller is more urgent
+    private func effectiveLevel(of request: PendingDownloadRequest, now: TimeInterval) -> Int {
+        guard agingInterval > 0 else { return request.priority.rank }
+        return Int(((request.schedulingKey - now) / agingInterval).rounded(.up))
+    }
+}
+
+// MARK: - Request heap
+
+/// Indexed min-heap of pending requests
+/// The position of a request is kept in the request itself (`index`), so removal and updates are O(log n)
+private final class RequestHeap {
+    private(set) var heap: [PendingDownloadRequest] = []
+    private let index: ReferenceWritableKeyPath<PendingDownloadRequest, Int?>
+    private let isOrderedBefore: (PendingDownloadRequest, PendingDownloadRequest) -> Bool
+
+    /// - Parameters:
+    ///   - index: Property of the request holding its position in this heap
+    ///   - isOrderedBefore: Heap order, the first request is the smallest
+    init(
+        index: ReferenceWritableKeyPath<PendingDownloadRequest, Int?>,
+        isOrderedBefore: @escaping (PendingDownloadRequest, PendingDownloadRequest) -> Bool
+    ) {
+        self.index = index
+        self.isOrderedBefore = isOrderedBefore
+    }
+
+    func insert(_ request: PendingDownloadRequest) {
+        request[keyPath: index] = heap.count
+        heap.append(request)
+        siftUp(from: heap.count - 1)
+    }
+
+    /// - Returns: false when the request is not in this heap
+    @discardableResult
+    func remove(_ request: PendingDownloadRequest) -> Bool {
+        guard let position = request[keyPath: index], position < heap.count, heap[position] === request else { return false }
+
+        let lastIndex = heap.count - 1
+        if position != lastIndex {
+            swapAt(position, lastIndex)
+        }
+        heap.removeLast()
+        request[keyPath: index] = nil
+
+        if position < heap.count {
+            siftDown(from: position)
+            siftUp(from: position)
+        }
+        return true
+    }
+
+    /// Restore heap order after the key of a queued request changed
+    func update(_ request: PendingDownloadRequest) {
+        guard let position = request[keyPath: index], position < heap.count, heap[position] === request else { return }
+        siftDown(from: position)
+        siftUp(from: request[keyPath: index] ?? position)
+    }
+
+    /// Empty the heap, requests lose their position
+    func removeAll() {
+        for request in heap {
+            request[keyPath: index] = nil
+        }
+        heap.removeAll()
+    }
+
+    private func swapAt(_ i: Int, _ j: Int) {
+        heap.swapAt(i, j)
+        heap[i][keyPath: index] = i
+        heap[j][keyPath: index] = j
+    }
+
+    private func siftUp(from position: Int) {
+        var child = position
+        while child > 0 {
+            let parent = (child - 1) / 2
+            guard isOrderedBefore(heap[child], heap[parent]) else { return }
+            swapAt(child, parent)
+            child = parent
+        }
+    }
+
+    private func siftDown(from position: Int) {
+        var parent = position
+        while true {
+            let left = 2 * parent + 1
+            let right = left + 1
+            var first = parent
+            if left < heap.count, isOrderedBefore(heap[left], heap[first]) {
+                first = left
+            }
+            if right < heap.count, isOrderedBefore(heap[right], heap[first]) {
+                first = right
+            }
+            guard first != parent else { return }
+            swapAt(parent, first)
+            parent = first
+        }
+    }
+}
@@ -0,0 +1,106 @@
+//
+//  ProgressiveDecoder.swift
+//  ImageDownloader
+//
+//  Incremental decoding of partially downloaded images
+//
+
+import Foundation
+import ImageIO
+import UIKit
+
+/// Decodes intermediate frames of an image while its bytes are still arriving
+/// - Backed by an incremental `CGImageSource`: progressive JPEG scans and interlaced PNG passes
+///   give full-size lower quality frames, baseline images give the rows received so far
+/// - At most one frame per `minInterval`, decoded off the caller thread on a serial queue
+/// - When a decode is still running the newest snapshot replaces the waiting one, stale data is never decoded
+/// Thread safe
+internal final class ProgressiveDecoder {
+    private let minInterval: TimeInterval
+    private let onFrame: (UIImage) -> Void
+    private let source = CGImageSourceCreateIncremental(nil)
+    private let decodeQueue = DispatchQueue(label: "com.imagedownloader.progressive", qos: .utility)
+
+    // MARK: - Private State (Access only with lock)
+    private let lock = NSLock()
+    private var lastFrameTime: Date?
+    private var isDecoding = false
+    private var waitingData: Data?
+    private var isFinished = false
+
+    /// - Parameters:
+    ///   - minInterval: Minimum seconds between two emitted frames
+    ///   - onFrame: Called with every intermediate frame, on the decode queue
+    init(minInterval: TimeInterval, onFrame: @escaping (UIImage) -> Void) {
+        self.minInterval = minInterval
+        self.onFrame = onFrame
+    }
+
+    /// Offer the bytes received so far (whole body prefix, not a chunk)
+    func update(with data: Data) {
+        lock.lock()
+        defer { lock.unlock() }
+        guard !isFinished else { return }
+
+        if let last = lastFrameTime, Date().timeIntervalSince(last) < minInterval {
+            return
+        }
+        lastFrameTime = Date()
+
+        if isDecoding {
+            waitingData = data
+            return
+        }
+        isDecoding = true
+        decodeQueue.async { [weak self] in
+            self?.decodeLoop(data)
+        }
+    }
+
+    /// Stop emitting frames, the final image is decoded by the regular decode stage
+    func finish() {
+        lock.lock()
+        isFinished = true
+        waitingData = nil
+        lock.unlock()
+    }
+
+    // MARK: - Private
+
+    private func decodeLoop(_ initial: Data) {
+        var data = initial
+        while true {
+            if let frame = decodeFrame(data) {
+                onFrame(frame)
+            }
+
+            lock.lock()
+            guard !isFinished, let next = waitingData else {
+                waitingData = nil
+                isDecoding = false
+                lock.unlock()
+                return
+            }
+            waitingData = nil
+            lock.unlock()
+            data = next
+        }
+    }
+
+    private func decodeFrame(_ data: Data) -> UIImage? {
+        CGImageSourceUpdateData(source, data as CFData, false)
+
+        // Header not parsed yet, nothing to show
+        guard CGImageSourceGetCount(source) > 0 else { return nil }
+        let status = CGImageSourceGetStatusAtIndex(source, 0)
+        guard status == .statusIncomplete || status == .statusComplete else { return nil }
+
+        let options = [kCGImageSourceShouldCacheImmediately: true] as CFDictionary
+        guard let cgImage = CGImageSourceCreateImageAtIndex(source, 0, options) else { return nil }
+
+        lock.lock()
+        let finished = isFinished
+        lock.unlock()
+        return finished ? nil : UIImage(cgImage: cgImage)
+    }
+}
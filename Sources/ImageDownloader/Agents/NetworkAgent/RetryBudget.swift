@@ -0,0 +1,61 @@
+//
+//  RetryBudget.swift
+//  ImageDownloader
+//
+//  Token bucket limiting retries to a fraction of downloads
+//
+
+import Foundation
+
+/// Global retry budget of a NetworkAgent
+/// - Every new download deposits `ratio` token, every retry withdraws one
+/// - The bucket holds at most `maxTokens`, so a burst of failures can use the saved up budget once,
+///   then retries are capped at `ratio` of the download rate
+/// A flapping host can then add at most `ratio` extra load instead of multiplying it by `maxRetries`
+/// Thread safe
+internal final class RetryBudget {
+    private let lock = NSLock()
+    private let ratio: Double
+    private let maxTokens: Double
+    private var tokens: Double
+
+    private var retriesAllowed = 0
+    private var retriesDenied = 0
+
+    /// - Parameters:
+    ///   - ratio: Retries allowed per download (0.1 = at most 10% extra requests)
+    ///   - maxTokens: Retries that can be saved up, also the initial budget
+    init(ratio: Double, maxTokens: Double = 10) {
+        self.ratio = max(ratio, 0)
+        self.maxTokens = max(maxTokens, 1)
+        self.tokens = self.maxTokens
+    }
+
+    /// Record a new download (not a retry)
+    func recordRequest() {
+        lock.lock()
+        tokens = min(maxTokens, tokens + ratio)
+        lock.unlock()
+    }
+
+    /// Take a token for one retry
+    /// - Returns: false when the budget is exhausted and the failure must be reported instead
+    func tryWithdraw() -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard tokens >= 1 else {
+            retriesDenied += 1
+            return false
+        }
+        tokens -= 1
+        retriesAllowed += 1
+        return true
+    }
+
+    /// Retries allowed and denied so far
+    var counts: (allowed: Int, denied: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        return (retriesAllowed, retriesDenied)
+    }
+}
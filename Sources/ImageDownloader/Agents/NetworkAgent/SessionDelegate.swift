@@ -2,20 +2,40 @@
 //  SessionDelegate.swift
 //  ImageDownloader
 //
-//  URLSession delegate for handling authentication challenges
+//  URLSession delegate for authentication challenges and streamed data tasks
 //
 
 import Foundation
 
-/// Shared URLSession delegate for handling authentication challenges
-internal final class SessionDelegate: NSObject, URLSessionDelegate {
+/// Shared URLSession delegate
+/// Routes data task callbacks to the `StreamingDownload` registered for the task
+internal final class SessionDelegate: NSObject, URLSessionDataDelegate {
 
     static let shared = SessionDelegate()
 
+    private let lock = NSLock()
+    /// Streaming state per task: taskIdentifier -> download
+    private var downloads: [Int: StreamingDownload] = [:]
+
     private override init() {
         super.init()
     }
 
+    /// Route callbacks of a task to a download, call before `resume()`
+    func register(_ download: StreamingDownload, for task: URLSessionTask) {
+        lock.lock()
+        downloads[task.taskIdentifier] = download
+        lock.unlock()
+    }
+
+    private func download(for task: URLSessionTask) -> StreamingDownload? {
+        lock.lock()
+        defer { lock.unlock() }
+        return downloads[task.taskIdentifier]
+    }
+
+    // MARK: - URLSessionDelegate
+
     func urlSession(
         _ session: URLSession,
         didReceive challenge: URLAuthenticationChallenge,
@@ -23,4 +43,28 @@ internal final class SessionDelegate: NSObject, URLSessionDelegate {
     ) {
         completionHandler(.performDefaultHandling, nil)
     }
+
+    // MARK: - URLSessionDataDelegate
+
+    func urlSession(
+        _ session: URLSession,
+        dataTask: URLSessionDataTask,
+        didReceive response: URLResponse,
+        completionHandler: @escaping (URLSession.ResponseDisposition) -> Void
+    ) {
+        download(for: dataTask)?.didReceive(response: response)
+        completionHandler(.allow)
+    }
+
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+        download(for: dataTask)?.didReceive(data: data)
+    }
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        lock.lock()
+        let download = downloads.removeValue(forKey: task.taskIdentifier)
+        lock.unlock()
+
+        download?.didComplete(error: error)
+    }
 }
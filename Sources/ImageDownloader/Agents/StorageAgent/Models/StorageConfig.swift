@@ -14,6 +14,20 @@ struct StorageConfig {
     var identifierProvider: any ResourceIdentifierProvider
     var pathProvider: any StoragePathProvider
     var compressionProvider: any ImageCompressionProvider
+    /// Revalidate stale stored images with the server (ETag / Last-Modified)
+    var revalidatesStoredImages: Bool
+    /// Store downloaded bytes as received instead of re-encoding the decoded image
+    var storesOriginalData: Bool
+    /// Disk budget in bytes of stored images (0 = unlimited)
+    var maxStorageSize: Int
+    /// Disk budget in number of stored images (0 = unlimited)
+    var maxFileCount: Int
+    /// Which images are removed first when over budget
+    var evictionPolicy: IDStorageEvictionPolicy
+    /// Images up to this size in bytes are appended to shared pack segments (0 = one file per image)
+    var packedImageMaxSize: Int
+    /// Disk operations running at the same time on the storage I/O executor
+    var maxConcurrentIO: Int
 
     // Default initializer
     init(
@@ -21,12 +35,26 @@ struct StorageConfig {
         storagePath: String? = nil,
         identifierProvider: any ResourceIdentifierProvider = MD5IdentifierProvider(),
         pathProvider: any StoragePathProvider = FlatHierarchicalPathProvider(),
-        compressionProvider: any ImageCompressionProvider = PNGCompressionProvider()
+        compressionProvider: any ImageCompressionProvider = PNGCompressionProvider(),
+        revalidatesStoredImages: Bool = true,
+        storesOriginalData: Bool = true,
+        maxStorageSize: Int = 0,
+        maxFileCount: Int = 0,
+        evictionPolicy: IDStorageEvictionPolicy = .lru,
+        packedImageMaxSize: Int = 0,
+        maxConcurrentIO: Int = 4
     ) {
         self.shouldSaveToStorage = shouldSaveToStorage
         self.storagePath = storagePath
         self.identifierProvider = identifierProvider
         self.pathProvider = pathProvider
         self.compressionProvider = compressionProvider
+        self.revalidatesStoredImages = revalidatesStoredImages
+        self.storesOriginalData = storesOriginalData
+        self.maxStorageSize = maxStorageSize
+        self.maxFileCount = maxFileCount
+        self.evictionPolicy = evictionPolicy
+        self.packedImageMaxSize = packedImageMaxSize
+        self.maxConcurrentIO = maxConcurrentIO
     }
 }
@@ -0,0 +1,357 @@
+//
+//  PackStore.swift
+//  ImageDownloader
+//
+//  Append-only segment files holding small images
+//
+
+import Foundation
+
+/// Small images appended into shared segment files instead of one file each
+/// - Record: header (magic, flags, identifier length, data length), identifier, data.
+///   Records are self describing, so the index of packed images can be rebuilt by scanning segments
+/// - Reads slice a memory-mapped segment: no open/close per image and no copy
+/// - Removal only sets the tombstone flag of the record; segments that are mostly dead
+///   are compacted by moving their live records to the active segment
+/// Thread safe
+internal final class PackStore {
+    /// Directory of the segments, hidden so the storage directory scan skips it
+    static let directoryName = ".packs"
+
+    private static let magic: UInt32 = 0x4B50_4449 // "IDPK"
+    private static let tombstoneFlag: UInt8 = 1
+    /// magic (4) + flags (1) + identifier length (2) + data length (4)
+    private static let headerSize = 11
+    private static let flagsOffset: UInt64 = 4
+
+    private let directory: URL
+    private let storageDirectory: URL
+    private let maxSegmentSize: Int
+    /// Dead fraction of a sealed segment that makes it worth compacting
+    private let compactionRatio = 0.5
+    private let fileManager = FileManager.default
+    private let lock = NSLock()
+
+    private struct Segment {
+        var size: Int64 = 0
+        var deadBytes: Int64 = 0
+    }
+
+    private var isLoaded = false
+    /// Segment number -> accounting
+    private var segments: [Int: Segment] = [:]
+    private var activeNumber = 0
+    private var activeHandle: FileHandle?
+    /// Mapped segments, remapped when a read goes past the mapped length
+    private var mappedSegments: [Int: Data] = [:]
+
+    /// - Parameters:
+    ///   - storageDirectory: Storage directory, segment paths are relative to it
+    ///   - maxSegmentSize: Size after which a new segment is started
+    init(storageDirectory: URL, maxSegmentSize: Int = 4 * 1024 * 1024) {
+        self.storageDirectory = storageDirectory
+        self.directory = storageDirectory.appendingPathComponent(Self.directoryName)
+        self.maxSegmentSize = maxSegmentSize
+    }
+
+    deinit {
+        try? activeHandle?.close()
+    }
+
+    // MARK: - Blobs
+
+    /// Append an image to the active segment
+    /// - Returns: Segment path relative to the storage directory and record offset, nil when the write failed
+    func append(_ data: Data, identifier: String) -> (relativePath: String, offset: Int64)? {
+        let identifierData = Data(identifier.utf8)
+        guard identifierData.count <= Int(UInt16.max), data.count <= Int(UInt32.max) else { return nil }
+
+        var record = Data(capacity: Self.headerSize + identifierData.count + data.count)
+        Self.appendInteger(Self.magic, to: &record)
+        record.append(0)
+        Self.appendInteger(UInt16(identifierData.count), to: &record)
+        Self.appendInteger(UInt32(data.count), to: &record)
+        record.append(identifierData)
+        record.append(data)
+
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+
+        var segment = segments[activeNumber] ?? Segment()
+        if segment.size > 0, segment.size + Int64(record.count) > Int64(maxSegmentSize) {
+            try? activeHandle?.close()
+            activeHandle = nil
+            activeNumber += 1
+            segment = Segment()
+        }
+        guard let handle = activeHandleUnsafe(),
+              let offset = try? handle.compatSeekToEnd(),
+              (try? handle.compatWrite(record)) != nil else {
+            return nil
+        }
+
+        segment.size = Int64(offset) + Int64(record.count)
+        segments[activeNumber] = segment
+        return (relativePath(ofSegment: activeNumber), Int64(offset))
+    }
+
+    /// Image data of a record, a zero-copy slice of the mapped segment
+    /// The lock only guards the mapping table, mapping a segment runs outside it so reads of
+    /// other segments (and appends) are not held up
+    func read(relativePath: String, offset: Int64) -> Data? {
+        guard let number = segmentNumber(of: relativePath) else { return nil }
+
+        lock.lock()
+        loadIfNeeded()
+        let mapped = mappedSegments[number]
+        lock.unlock()
+
+        if let mapped = mapped, let data = Self.recordData(in: mapped, at: Int(offset)) {
+            return data.isDeleted ? nil : data.slice
+        }
+
+        // Not mapped yet, or the record was appended after the mapping was made
+        guard let remapped = try? Data(contentsOf: segmentURL(number), options: .alwaysMapped) else { return nil }
+        lock.lock()
+        // Skip segments compacted away meanwhile, keep the longest mapping
+        if segments[number] != nil, remapped.count > mappedSegments[number]?.count ?? -1 {
+            mappedSegments[number] = remapped
+        }
+        lock.unlock()
+
+        guard let data = Self.recordData(in: remapped, at: Int(offset)), !data.isDeleted else { return nil }
+        return data.slice
+    }
+
+    /// Mark a record deleted
+    /// - Returns: true when a segment is now worth compacting
+    @discardableResult
+    func remove(relativePath: String, offset: Int64) -> Bool {
+        guard let number = segmentNumber(of: relativePath) else { return false }
+
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+
+        guard let handle = try? FileHandle(forUpdating: segmentURL(number)) else { return false }
+        defer { try? handle.close() }
+
+        guard (try? handle.seek(toOffset: UInt64(offset))) != nil,
+              let headerData = try? handle.compatRead(upToCount: Self.headerSize),
+              let header = Self.header(in: headerData, at: 0),
+              !header.isDeleted,
+              (try? handle.seek(toOffset: UInt64(offset) + Self.flagsOffset)) != nil,
+              (try? handle.compatWrite(Data([Self.tombstoneFlag]))) != nil else {
+            return false
+        }
+        // Parsed at 0, so the end is the record length
+        segments[number]?.deadBytes += Int64(header.end)
+        return !compactableSegmentsUnsafe().isEmpty
+    }
+
+    // MARK: - Compaction
+
+    /// Move the live records of mostly dead segments to the active segment and delete them
+    /// - Parameter relocate: Called with identifier, old and new location; returns false when the
+    ///   index no longer points at the old location (the moved copy is then dropped)
+    func compact(
+        relocate: (_ identifier: String, _ from: (relativePath: String, packOffset: Int64), _ to: (relativePath: String, packOffset: Int64)) -> Bool
+    ) {
+        lock.lock()
+        loadIfNeeded()
+        let numbers = compactableSegmentsUnsafe()
+        lock.unlock()
+
+        for number in numbers {
+            let oldPath = relativePath(ofSegment: number)
+            guard let segmentData = try? Data(contentsOf: segmentURL(number), options: .alwaysMapped) else { continue }
+
+            for record in Self.records(in: segmentData) where !record.header.isDeleted {
+                let data = segmentData[record.header.dataStart..<record.header.end]
+                guard let moved = append(Data(data), identifier: record.identifier) else { continue }
+                if !relocate(record.identifier, (oldPath, Int64(record.offset)), (moved.relativePath, moved.offset)) {
+                    remove(relativePath: moved.relativePath, offset: moved.offset)
+                }
+            }
+
+            lock.lock()
+            segments.removeValue(forKey: number)
+            mappedSegments.removeValue(forKey: number)
+            try? fileManager.removeItem(at: segmentURL(number))
+            lock.unlock()
+        }
+    }
+
+    /// Sealed segments with at least `compactionRatio` dead bytes
+    private func compactableSegmentsUnsafe() -> [Int] {
+        segments.compactMap { number, segment in
+            guard number != activeNumber, segment.size > 0,
+                  Double(segment.deadBytes) >= Double(segment.size) * compactionRatio else {
+                return nil
+            }
+            return number
+        }
+        .sorted()
+    }
+
+    // MARK: - Recovery
+
+    /// Live records of every segment, used to rebuild the storage index
+    /// A later record of the same identifier (rewritten image) comes last and wins
+    func scanEntries() -> [(identifier: String, entry: StorageIndexEntry)] {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+
+        var entries: [(identifier: String, entry: StorageIndexEntry)] = []
+        for number in segments.keys.sorted() {
+            guard let segmentData = try? Data(contentsOf: segmentURL(number), options: .alwaysMapped) else { continue }
+            let path = relativePath(ofSegment: number)
+            for record in Self.records(in: segmentData) where !record.header.isDeleted {
+                let data = segmentData[record.header.dataStart..<record.header.end]
+                let entry = StorageIndexEntry(
+                    relativePath: path,
+                    packOffset: Int64(record.offset),
+                    size: Int64(data.count),
+                    lastAccess: Date(),
+                    accessCount: 0,
+                    format: ImageFormat(data: Data(data.prefix(12)))?.rawValue
+                )
+                entries.append((record.identifier, entry))
+            }
+        }
+        return entries
+    }
+
+    /// Forget every segment, used after the storage directory was deleted
+    func reset() {
+        lock.lock()
+        defer { lock.unlock() }
+        try? activeHandle?.close()
+        activeHandle = nil
+        segments.removeAll()
+        mappedSegments.removeAll()
+        activeNumber = 0
+        isLoaded = true
+    }
+
+    // MARK: - Segments
+
+    private func segmentURL(_ number: Int) -> URL {
+        directory.appendingPathComponent(String(format: "segment-%06d.pack", number))
+    }
+
+    private func relativePath(ofSegment number: Int) -> String {
+        Self.directoryName + "/" + segmentURL(number).lastPathComponent
+    }
+
+    private func segmentNumber(of relativePath: String) -> Int? {
+        let name = (relativePath as NSString).lastPathComponent
+        guard name.hasPrefix("segment-"), name.hasSuffix(".pack") else { return nil }
+        return Int(name.dropFirst("segment-".count).dropLast(".pack".count))
+    }
+
+    private func activeHandleUnsafe() -> FileHandle? {
+        if let handle = activeHandle, fileManager.fileExists(atPath: segmentURL(activeNumber).path) {
+            return handle
+        }
+        try? activeHandle?.close()
+        try? fileManager.createDirectory(at: directory, withIntermediateDirectories: true)
+        let url = segmentURL(activeNumber)
+        if !fileManager.fileExists(atPath: url.path) {
+            fileManager.createFile(atPath: url.path, contents: nil)
+        }
+        activeHandle = try? FileHandle(forWritingTo: url)
+        return activeHandle
+    }
+
+    /// Account every segment on disk, truncating a record torn by a crash at the end of a segment
+    private func loadIfNeeded() {
+        guard !isLoaded else { return }
+        isLoaded = true
+
+        guard let names = try? fileManager.contentsOfDirectory(atPath: directory.path) else { return }
+        for name in names {
+            guard let number = segmentNumber(of: name),
+                  let segmentData = try? Data(contentsOf: segmentURL(number), options: .alwaysMapped) else {
+                continue
+            }
+            var segment = Segment()
+            for record in Self.records(in: segmentData) {
+                segment.size = Int64(record.header.end)
+                if record.header.isDeleted {
+                    segment.deadBytes += Int64(record.header.end - record.offset)
+                }
+            }
+            if segment.size < Int64(segmentData.count),
+               let handle = try? FileHandle(forWritingTo: segmentURL(number)) {
+                try? handle.truncate(atOffset: UInt64(segment.size))
+                try? handle.close()
+            }
+            segments[number] = segment
+            activeNumber = max(activeNumber, number)
+        }
+    }
+
+    // MARK: - Record format
+
+    private struct RecordHeader {
+        let isDeleted: Bool
+        /// Absolute offsets in the segment
+        let identifierStart: Int
+        let dataStart: Int
+        let end: Int
+    }
+
+    /// Parse the header of the record starting at `offset`, nil when it is not a record
+    private static func header(in data: Data, at offset: Int) -> RecordHeader? {
+        let base = data.startIndex + offset
+        guard offset >= 0, base + headerSize <= data.endIndex,
+              readInteger(UInt32.self, in: data, at: base) == magic,
+              let identifierLength = readInteger(UInt16.self, in: data, at: base + 5),
+              let dataLength = readInteger(UInt32.self, in: data, at: base + 7) else {
+            return nil
+        }
+        let identifierStart = offset + headerSize
+        let dataStart = identifierStart + Int(identifierLength)
+        return RecordHeader(
+            isDeleted: data[base + 4] & tombstoneFlag != 0,
+            identifierStart: identifierStart,
+            dataStart: dataStart,
+            end: dataStart + Int(dataLength)
+        )
+    }
+
+    /// Data of the complete record at `offset`, nil when the mapping ends before it
+    private static func recordData(in data: Data, at offset: Int) -> (slice: Data, isDeleted: Bool)? {
+        guard let header = header(in: data, at: offset), header.end <= data.count else { return nil }
+        return (data[(data.startIndex + header.dataStart)..<(data.startIndex + header.end)], header.isDeleted)
+    }
+
+    /// Every complete record of a segment, in order
+    private static func records(in data: Data) -> [(offset: Int, identifier: String, header: RecordHeader)] {
+        var records: [(offset: Int, identifier: String, header: RecordHeader)] = []
+        var offset = 0
+        while let header = Self.header(in: data, at: offset), header.end <= data.count {
+            let identifierData = data[(data.startIndex + header.identifierStart)..<(data.startIndex + header.dataStart)]
+            records.append((offset, String(decoding: identifierData, as: UTF8.self), header))
+            offset = header.end
+        }
+        return records
+    }
+
+    private static func appendInteger<T: FixedWidthInteger>(_ value: T, to data: inout Data) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+
+    private static func readInteger<T: FixedWidthInteger>(_ type: T.Type, in data: Data, at index: Int) -> T? {
+        let size = MemoryLayout<T>.size
+        guard index >= data.startIndex, index + size <= data.endIndex else { return nil }
+        var value: T = 0
+        for byteIndex in 0..<size {
+            value |= T(data[index + byteIndex]) << (8 * byteIndex)
+        }
+        return value
+    }
+}
@@ -18,6 +18,38 @@ final class StorageAgent {
     private let identifierProvider: ResourceIdentifierProvider
     private let pathProvider: StoragePathProvider
     private let compressionProvider: ImageCompressionProvider
+    /// Downloaded bytes are written as received, `compressionProvider` only re-encodes images without them
+    private let storesOriginalData: Bool
+
+    /// identifier -> stored file, answers lookups and misses without filesystem access
+    private let index: StorageIndex
+    /// Segment files holding images up to `packedImageMaxSize` bytes
+    private let packStore: PackStore
+    /// 0 = every image has a file of its own
+    private let packedImageMaxSize: Int
+    private var isCompactionScheduled = false
+    /// Runs the asynchronous API, so callers in Swift concurrency never block on disk
+    private let ioExecutor: StorageIOExecutor
+    /// Disk budget, 0 = unlimited
+    private let maxStorageSize: Int64
+    private let maxFileCount: Int
+    private let evictionPolicy: IDStorageEvictionPolicy
+    /// A trim stops at this fraction of the budget, so it does not run again after every write
+    private let trimTargetRatio = 0.9
+    /// Files removed per trim pass, further passes are queued until below target
+    private let maxEvictionsPerPass = 50
+    private let trimQueue = DispatchQueue(label: "com.imagedownloader.storage.trim", qos: .background)
+    private let trimLock = NSLock()
+    private var isTrimScheduled = false
+
+    /// Persists the index access times when the app goes to background
+    private var backgroundObserver: NSObjectProtocol?
+    /// URL -> identifier, so the identifier is not re-hashed on every lookup
+    private let identifierCache: NSCache<NSString, NSString> = {
+        let cache = NSCache<NSString, NSString>()
+        cache.countLimit = 1000
+        return cache
+    }()
     
     // MARK: - Initialization
     init(
@@ -35,12 +67,219 @@ final class StorageAgent {
         self.identifierProvider = config.identifierProvider
         self.pathProvider = config.pathProvider
         self.compressionProvider = config.compressionProvider
+        self.storesOriginalData = config.storesOriginalData
+        let packStore = PackStore(storageDirectory: _storageURL)
+        self.packStore = packStore
+        self.packedImageMaxSize = max(config.packedImageMaxSize, 0)
+        self.index = StorageIndex(
+            directory: _storageURL,
+            ignoredSuffixes: [Self.metadataExtension],
+            packedEntries: { packStore.scanEntries() }
+        )
+        self.maxStorageSize = Int64(max(config.maxStorageSize, 0))
+        self.maxFileCount = max(config.maxFileCount, 0)
+        self.evictionPolicy = config.evictionPolicy
+        self.ioExecutor = StorageIOExecutor(maxConcurrentOperations: config.maxConcurrentIO)
         
         createStorageDirectoryIfNeeded()
+
+        backgroundObserver = NotificationCenter.default.addObserver(
+            forName: UIApplication.didEnterBackgroundNotification,
+            object: nil,
+            queue: nil
+        ) { [index] _ in
+            index.flush()
+        }
+
+        // A store left over budget (or configured with a smaller one) is trimmed off the caller's thread
+        trimQueue.async { [weak self] in
+            self?.scheduleTrimIfNeeded()
+        }
+    }
+
+    deinit {
+        if let backgroundObserver = backgroundObserver {
+            NotificationCenter.default.removeObserver(backgroundObserver)
+        }
+        index.flush()
     }
     
     
     
+    /// Decode a stored file: original bytes as they came from the server, re-encoded files by their provider
+    private func decodeStoredData(_ data: Data) -> UIImage? {
+        if storesOriginalData, ImageFormat(data: data) != nil, let image = UIImage(data: data) {
+            return image
+        }
+        return compressionProvider.decompress(data)
+    }
+
+    private func identifier(for url: URL) -> String {
+        let key = url.absoluteString as NSString
+        if let cached = identifierCache.object(forKey: key) {
+            return cached as String
+        }
+        let identifier = identifierProvider.identifier(for: url)
+        identifierCache.setObject(identifier as NSString, forKey: key)
+        return identifier
+    }
+
+    /// Path a new file for the URL is written to
+    private func relativePath(for url: URL, identifier: String) -> String {
+        return pathProvider.path(for: url, identifier: identifier)
+    }
+
+    /// Write image data and index it, small images go to the pack segments
+    private func writeImageData(_ data: Data, for url: URL, format: ImageFormat?) -> Bool {
+        createStorageDirectoryIfNeeded()
+
+        let identifier = self.identifier(for: url)
+        let previous = index.entry(for: identifier)
+        // Overwritten in place by the new file, nothing left to drop
+        var isPreviousReplaced = false
+
+        if packedImageMaxSize > 0, data.count <= packedImageMaxSize {
+            guard let location = packStore.append(data, identifier: identifier) else { return false }
+            index.put(identifier, relativePath: location.relativePath, packOffset: location.offset, size: Int64(data.count), format: format)
+        } else {
+            createSubdirectoriesIfNeeded(for: url)
+            let relativePath = self.relativePath(for: url, identifier: identifier)
+            let filePath = _storageURL.appendingPathComponent(relativePath).path
+            guard (try? data.write(to: URL(fileURLWithPath: filePath), options: .atomic)) != nil else {
+                return false
+            }
+            // Validators of the previous image do not describe the new one
+            try? _fileManager.removeItem(atPath: metadataPath(forFilePath: filePath))
+            index.put(identifier, relativePath: relativePath, size: Int64(data.count), format: format)
+            isPreviousReplaced = previous?.packOffset == nil && previous?.relativePath == relativePath
+        }
+
+        // Previous image elsewhere (packed, or path provider changed): drop it with its validators
+        if let previous = previous, !isPreviousReplaced {
+            removeStoredData(previous, identifier: identifier)
+        }
+        scheduleTrimIfNeeded()
+        return true
+    }
+
+    /// Delete a stored image (file or pack record) and its validators sidecar
+    @discardableResult
+    private func removeStoredData(_ entry: StorageIndexEntry, identifier: String) -> Bool {
+        try? _fileManager.removeItem(atPath: metadataPath(for: entry, identifier: identifier))
+
+        guard let packOffset = entry.packOffset else {
+            let filePath = _storageURL.appendingPathComponent(entry.relativePath).path
+            return (try? _fileManager.removeItem(atPath: filePath)) != nil
+        }
+        if packStore.remove(relativePath: entry.relativePath, offset: packOffset) {
+            scheduleCompaction()
+        }
+        return true
+    }
+
+    /// Bytes of a stored image, packed ones are a slice of the mapped segment
+    private func storedData(for entry: StorageIndexEntry) -> Data? {
+        if let packOffset = entry.packOffset {
+            return packStore.read(relativePath: entry.relativePath, offset: packOffset)
+        }
+        return try? Data(contentsOf: _storageURL.appendingPathComponent(entry.relativePath))
+    }
+
+    /// Queue a compaction of the pack segments that are mostly deleted records
+    private func scheduleCompaction() {
+        trimLock.lock()
+        guard !isCompactionScheduled else {
+            trimLock.unlock()
+            return
+        }
+        isCompactionScheduled = true
+        trimLock.unlock()
+
+        trimQueue.async { [weak self] in
+            guard let self = self else { return }
+            self.trimLock.lock()
+            self.isCompactionScheduled = false
+            self.trimLock.unlock()
+
+            self.packStore.compact { identifier, old, new in
+                self.index.relocate(identifier, from: old, to: new)
+            }
+        }
+    }
+
+    // MARK: - Disk budget
+
+    private var hasBudget: Bool {
+        maxStorageSize > 0 || maxFileCount > 0
+    }
+
+    /// Whether stored images are above `ratio` of the budget (1 = the budget itself)
+    private func exceedsBudget(size: Int64, count: Int, ratio: Double = 1) -> Bool {
+        (maxStorageSize > 0 && Double(size) > Double(maxStorageSize) * ratio)
+            || (maxFileCount > 0 && Double(count) > Double(maxFileCount) * ratio)
+    }
+
+    /// Queue a background trim when the budget is exceeded, at most one trim runs at a time
+    private func scheduleTrimIfNeeded() {
+        guard hasBudget, exceedsBudget(size: index.totalSize, count: index.count) else { return }
+
+        trimLock.lock()
+        guard !isTrimScheduled else {
+            trimLock.unlock()
+            return
+        }
+        isTrimScheduled = true
+        trimLock.unlock()
+
+        trimQueue.async { [weak self] in
+            self?.trimPass()
+        }
+    }
+
+    /// Evict at most `maxEvictionsPerPass` images in policy order, then queue another pass
+    /// while still above target, so a large trim never holds the queue for long
+    private func trimPass() {
+        var size = index.totalSize
+        var count = index.count
+
+        if exceedsBudget(size: size, count: count, ratio: trimTargetRatio) {
+            for candidate in index.evictionCandidates(limit: maxEvictionsPerPass, policy: evictionPolicy) {
+                guard exceedsBudget(size: size, count: count, ratio: trimTargetRatio) else { break }
+                // Skip images read or rewritten since the candidates were picked
+                guard index.remove(candidate.identifier, ifUnchangedSince: candidate.entry) else { continue }
+                removeStoredData(candidate.entry, identifier: candidate.identifier)
+                size -= candidate.entry.size
+                count -= 1
+            }
+        }
+
+        if exceedsBudget(size: index.totalSize, count: index.count, ratio: trimTargetRatio) {
+            trimQueue.async { [weak self] in
+                self?.trimPass()
+            }
+        } else {
+            trimLock.lock()
+            isTrimScheduled = false
+            trimLock.unlock()
+        }
+    }
+
+    /// Suffix of the validators sidecar file
+    private static let metadataExtension = ".meta"
+
+    private func metadataPath(forFilePath filePath: String) -> String {
+        return filePath + Self.metadataExtension
+    }
+
+    /// Sidecar of a stored image, packed images share a segment so theirs is named by identifier
+    private func metadataPath(for entry: StorageIndexEntry, identifier: String) -> String {
+        guard entry.packOffset != nil else {
+            return metadataPath(forFilePath: _storageURL.appendingPathComponent(entry.relativePath).path)
+        }
+        let packDirectory = _storageURL.appendingPathComponent(PackStore.directoryName)
+        return packDirectory.appendingPathComponent(identifier).path + Self.metadataExtension
+    }
+
     private static func defaultStorageDirectory() -> URL {
         let paths = NSSearchPathForDirectoriesInDomains(.cachesDirectory, .userDomainMask, true)
         let cachePath = paths.first!
@@ -71,53 +310,83 @@ final class StorageAgent {
 
 // MARK: - Expose to manager
 extension StorageAgent {
-    /// Check if image exists in storage (synchronous)
+    /// Check if image exists in storage, answered from the index
     func hasImage(for url: URL) -> Bool {
-        let filePath = self.filePath(for: url)
-        return _fileManager.fileExists(atPath: filePath)
+        return index.entry(for: identifier(for: url)) != nil
     }
     
+    /// Stored image, a miss costs no filesystem access
     func image(for url: URL) -> UIImage? {
-        let filePath = self.filePath(for: url)
-        var image: UIImage? = nil
-        
-        if self._fileManager.fileExists(atPath: filePath) {
-            if let imageData = try? Data(contentsOf: URL(fileURLWithPath: filePath)) {
-                image = self.compressionProvider.decompress(imageData)
-            }
+        let identifier = self.identifier(for: url)
+        guard var entry = index.entry(for: identifier) else { return nil }
+
+        var imageData = storedData(for: entry)
+        // Moved by a pack compaction while it was read
+        if imageData == nil, let current = index.entry(for: identifier),
+           current.relativePath != entry.relativePath || current.packOffset != entry.packOffset {
+            entry = current
+            imageData = storedData(for: current)
         }
-        
-        return image
+        guard let imageData = imageData else {
+            // Deleted behind our back
+            _ = index.remove(identifier, ifUnchangedSince: entry)
+            return nil
+        }
+        index.touch(identifier)
+        return decodeStoredData(imageData)
     }
     
     func saveImage(_ image: UIImage, for url: URL) -> Bool {
-        // Ensure base storage directory exists
-        createStorageDirectoryIfNeeded()
-
-        // Create subdirectories if needed
-        self.createSubdirectoriesIfNeeded(for: url)
-
-        let filePath = self.filePath(for: url)
         guard let imageData = self.compressionProvider.compress(image) else {
             return false
         }
-
-        return (try? imageData.write(to: URL(fileURLWithPath: filePath), options: .atomic)) != nil
+        return writeImageData(imageData, for: url, format: ImageFormat(data: imageData))
     }
     
+    /// Write downloaded bytes as they are, no decode or re-encode
+    /// - Returns: false when the data is not a known image format or the write failed
+    @discardableResult
+    func saveImageData(_ data: Data, for url: URL) -> Bool {
+        guard let format = ImageFormat(data: data) else { return false }
+        return writeImageData(data, for: url, format: format)
+    }
+
+    @discardableResult
     func removeImage(for url: URL) -> Bool {
-        let filePath = self.filePath(for: url)
-        var success = false
-        
-        if self._fileManager.fileExists(atPath: filePath) {
-            success = (try? self._fileManager.removeItem(atPath: filePath)) != nil
+        let identifier = self.identifier(for: url)
+        guard let entry = index.entry(for: identifier) else { return false }
+
+        index.remove(identifier)
+        return removeStoredData(entry, identifier: identifier)
+    }
+
+    /// HTTP validators stored next to the image, nil when none were saved
+    func validators(for url: URL) -> ResourceValidators? {
+        let identifier = self.identifier(for: url)
+        guard let entry = index.entry(for: identifier) else { return nil }
+        let metaURL = URL(fileURLWithPath: metadataPath(for: entry, identifier: identifier))
+        guard let data = try? Data(contentsOf: metaURL) else { return nil }
+        return try? JSONDecoder().decode(ResourceValidators.self, from: data)
+    }
+
+    /// Persist HTTP validators in a `.meta` sidecar of the image file
+    @discardableResult
+    func saveValidators(_ validators: ResourceValidators, for url: URL) -> Bool {
+        // Only next to a stored image, a lone sidecar would never be cleaned up
+        let identifier = self.identifier(for: url)
+        guard let entry = index.entry(for: identifier),
+              let data = try? JSONEncoder().encode(validators) else {
+            return false
         }
-        return success
+        let metaURL = URL(fileURLWithPath: metadataPath(for: entry, identifier: identifier))
+        return (try? data.write(to: metaURL, options: .atomic)) != nil
     }
     
+    /// Path of the stored file of a URL (the segment file of a packed image),
+    /// or where it would be written when not stored
     func filePath(for url: URL) -> String {
-        let identifier = identifierProvider.identifier(for: url)
-        let relativePath = pathProvider.path(for: url, identifier: identifier)
+        let identifier = self.identifier(for: url)
+        let relativePath = index.entry(for: identifier)?.relativePath ?? relativePath(for: url, identifier: identifier)
         return _storageURL.appendingPathComponent(relativePath).path
     }
     
@@ -129,35 +398,99 @@ extension StorageAgent {
         return _storageURL
     }
     
+    /// Bytes on disk of every file in the storage directory and its subdirectories
+    /// (images, pack segments, validators sidecars and index files)
     func currentStorageSize() -> UInt {
         var totalSize: UInt = 0
-        
-        guard let files = try? _fileManager.contentsOfDirectory(atPath: _storageURL.path) else {
+        let keys: [URLResourceKey] = [.isRegularFileKey, .fileSizeKey]
+        guard let enumerator = _fileManager.enumerator(at: _storageURL, includingPropertiesForKeys: keys) else {
             return totalSize
         }
-        
-        for file in files {
-            let filePath = _storageURL.appendingPathComponent(file).path
-            if let attributes = try? _fileManager.attributesOfItem(atPath: filePath),
-               let fileSize = attributes[.size] as? UInt {
-                totalSize += fileSize
+
+        for case let fileURL as URL in enumerator {
+            if let values = try? fileURL.resourceValues(forKeys: Set(keys)),
+               values.isRegularFile == true,
+               let fileSize = values.fileSize {
+                totalSize += UInt(fileSize)
             }
         }
         
         return totalSize
     }
     
+    /// Number of stored images, in every subdirectory
     func fileCount() -> Int {
-        let a = try? _fileManager.contentsOfDirectory(atPath: _storageURL.path).count
-        return a ?? 0
+        return index.count
     }
     
     func removeAll() {
         do {
             try _fileManager.removeItem(at: _storageURL)
+            index.reset()
+            packStore.reset()
         } catch {
             print("Error removing all files from storage: \(error)")
         }
     }
 }
 
+
+// MARK: - Asynchronous I/O
+/// Same operations on the I/O executor: reads go before pending writes,
+/// writes of one URL keep their order
+extension StorageAgent {
+    /// Stored image, read and decoded off the caller's thread
+    func loadImage(for url: URL) async -> UIImage? {
+        await ioExecutor.read { [self] in
+            image(for: url)
+        }
+    }
+
+    func loadValidators(for url: URL) async -> ResourceValidators? {
+        await ioExecutor.read { [self] in
+            validators(for: url)
+        }
+    }
+
+    /// Queue a re-encode and write of an image
+    /// - Parameters:
+    ///   - validators: Saved next to the image once written
+    ///   - onlyIfMissing: Skip when the URL already has a stored image
+    ///   - isDiscardable: Dropped when reads pile up, for copies of images held elsewhere (memory cache)
+    func scheduleSaveImage(
+        _ image: UIImage,
+        for url: URL,
+        validators: ResourceValidators? = nil,
+        onlyIfMissing: Bool = false,
+        isDiscardable: Bool = false
+    ) {
+        ioExecutor.write(key: identifier(for: url), isDiscardable: isDiscardable) { [self] in
+            guard !onlyIfMissing || !hasImage(for: url) else { return }
+            if saveImage(image, for: url), let validators = validators {
+                saveValidators(validators, for: url)
+            }
+        }
+    }
+
+    /// Queue a write of downloaded bytes as they are
+    func scheduleSaveImageData(_ data: Data, for url: URL, validators: ResourceValidators? = nil) {
+        ioExecutor.write(key: identifier(for: url)) { [self] in
+            if saveImageData(data, for: url), let validators = validators {
+                saveValidators(validators, for: url)
+            }
+        }
+    }
+
+    func scheduleSaveValidators(_ validators: ResourceValidators, for url: URL) {
+        ioExecutor.write(key: identifier(for: url)) { [self] in
+            saveValidators(validators, for: url)
+        }
+    }
+
+    /// Queue a removal, after every write of the URL queued before it
+    func scheduleRemoveImage(for url: URL) {
+        ioExecutor.write(key: identifier(for: url)) { [self] in
+            removeImage(for: url)
+        }
+    }
+}
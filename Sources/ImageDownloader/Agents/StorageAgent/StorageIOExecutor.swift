@@ -0,0 +1,153 @@
+//
+//  StorageIOExecutor.swift
+//  ImageDownloader
+//
+//  Bounded-parallel disk I/O stage, keeps blocking file access off the cooperative thread pool
+//
+
+import Foundation
+
+/// Disk I/O stage of a StorageAgent
+/// - Runs on its own concurrent queue, at most `maxConcurrentOperations` operations at a time
+/// - Reads are served before writes; a write waiting longer than `maxWriteDeferral` goes first,
+///   so a steady stream of reads cannot starve writes forever
+/// - Writes of the same key run one at a time in submission order (a removal cannot overtake a save)
+/// - Discardable writes (copies of images that are also somewhere else) are dropped when
+///   reads pile up beyond the available slots
+/// Thread safe
+internal final class StorageIOExecutor {
+
+    private struct Job {
+        /// Writes only, serializes writes of the same image
+        let key: String?
+        let isDiscardable: Bool
+        let enqueueTime: TimeInterval
+        let work: () -> Void
+        /// Called instead of `work` when a discardable write is dropped
+        let discard: (() -> Void)?
+    }
+
+    private let maxConcurrentOperations: Int
+    private let maxWriteDeferral: TimeInterval = 1
+    private let workQueue = DispatchQueue(
+        label: "com.imagedownloader.storage.io",
+        qos: .utility,
+        attributes: .concurrent
+    )
+
+    // MARK: - Private State (Access only with lock)
+    private let lock = NSLock()
+    private var runningCount = 0
+    private var pendingReads: [Job] = []
+    private var pendingWrites: [Job] = []
+    /// Keys of the writes currently running
+    private var runningWriteKeys: Set<String> = []
+    private var discardedWrites = 0
+
+    init(maxConcurrentOperations: Int) {
+        self.maxConcurrentOperations = max(1, maxConcurrentOperations)
+    }
+
+    // MARK: - Submission
+
+    /// Run a read ahead of queued writes
+    func read<T>(_ work: @escaping () -> T) async -> T {
+        await withCheckedContinuation { continuation in
+            submit(Job(key: nil, isDiscardable: false, enqueueTime: Self.now, work: {
+                continuation.resume(returning: work())
+            }, discard: nil), isRead: true)
+        }
+    }
+
+    /// Queue a write
+    /// - Parameters:
+    ///   - key: Writes with the same key run in submission order, never concurrently
+    ///   - isDiscardable: May be dropped under read pressure, `discard` is then called instead
+    func write(key: String, isDiscardable: Bool = false, discard: (() -> Void)? = nil, _ work: @escaping () -> Void) {
+        submit(Job(key: key, isDiscardable: isDiscardable, enqueueTime: Self.now, work: work, discard: discard), isRead: false)
+    }
+
+    /// Writes dropped under read pressure since creation
+    var discardedWriteCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return discardedWrites
+    }
+
+    // MARK: - Private
+
+    private static var now: TimeInterval {
+        ProcessInfo.processInfo.systemUptime
+    }
+
+    private func submit(_ job: Job, isRead: Bool) {
+        lock.lock()
+        if isRead {
+            pendingReads.append(job)
+        } else {
+            pendingWrites.append(job)
+        }
+        let dropped = isRead ? dropDiscardableWritesIfHotUnsafe() : []
+        let ready = nextJobsUnsafe()
+        lock.unlock()
+
+        dropped.forEach { $0.discard?() }
+        ready.forEach(run)
+    }
+
+    private func run(_ job: Job) {
+        workQueue.async { [weak self] in
+            job.work()
+            self?.finish(job)
+        }
+    }
+
+    /// Free the slot of a finished job and start whatever can run now
+    private func finish(_ job: Job) {
+        lock.lock()
+        runningCount -= 1
+        if let key = job.key {
+            runningWriteKeys.remove(key)
+        }
+        let ready = nextJobsUnsafe()
+        lock.unlock()
+
+        ready.forEach(run)
+    }
+
+    /// Take jobs for every free slot, reads first
+    private func nextJobsUnsafe() -> [Job] {
+        var ready: [Job] = []
+        while runningCount < maxConcurrentOperations, let job = nextJobUnsafe() {
+            runningCount += 1
+            if let key = job.key {
+                runningWriteKeys.insert(key)
+            }
+            ready.append(job)
+        }
+        return ready
+    }
+
+    private func nextJobUnsafe() -> Job? {
+        let writeIndex = pendingWrites.firstIndex { job in
+            job.key.map { !runningWriteKeys.contains($0) } ?? true
+        }
+        if let writeIndex = writeIndex,
+           pendingReads.isEmpty || Self.now - pendingWrites[writeIndex].enqueueTime > maxWriteDeferral {
+            return pendingWrites.remove(at: writeIndex)
+        }
+        return pendingReads.isEmpty ? nil : pendingReads.removeFirst()
+    }
+
+    /// More reads waiting than slots: drop the writes nobody depends on
+    private func dropDiscardableWritesIfHotUnsafe() -> [Job] {
+        guard pendingReads.count >= maxConcurrentOperations,
+              pendingWrites.contains(where: { $0.isDiscardable }) else {
+            return []
+        }
+        let dropped = pendingWrites.filter { $0.isDiscardable }
+        pendingWrites.removeAll { $0.isDiscardable }
+        discardedWrites += dropped.count
+        return dropped
+    }
+}
@@ -0,0 +1,395 @@
+//
+//  StorageIndex.swift
+//  ImageDownloader
+//
+//  Persistent in-memory index of the stored images
+//
+
+import Foundation
+
+/// Index record of one stored image
+struct StorageIndexEntry: Codable {
+    /// Path of the image file, relative to the storage directory
+    var relativePath: String
+    /// Offset of the record in the pack segment `relativePath`, nil when the image has a file of its own
+    var packOffset: Int64?
+    /// File size in bytes
+    var size: Int64
+    var lastAccess: Date
+    /// Reads since the image was written
+    var accessCount: Int
+    /// `ImageFormat` raw value, nil when the data was not sniffed
+    var format: String?
+}
+
+/// identifier -> stored file, kept in memory so lookups and misses never touch the filesystem
+/// - Persistence: a snapshot plus an append-only journal of JSON lines (one put or removal each),
+///   compacted into a new snapshot once the journal outgrows the index
+/// - Access times are only journaled in batches, losing the last few on a crash is harmless
+/// - Loaded lazily on first use; missing or corrupted files are rebuilt from a directory scan
+///   plus the records of the pack segments
+/// Thread safe
+internal final class StorageIndex {
+    private static let snapshotFileName = ".storage-index"
+    private static let journalFileName = ".storage-index.journal"
+    /// Suffix of sidecar files that are not images, skipped by the directory scan
+    private let ignoredSuffixes: [String]
+    /// Live records of the pack segments, which the directory scan skips
+    private let packedEntries: (() -> [(identifier: String, entry: StorageIndexEntry)])?
+
+    private let directory: URL
+    private let fileManager = FileManager.default
+    private let lock = NSLock()
+
+    private var entries: [String: StorageIndexEntry] = [:]
+    /// Sum of the indexed file sizes
+    private var _totalSize: Int64 = 0
+    private var isLoaded = false
+    /// Records appended since the last snapshot
+    private var journalCount = 0
+    private var journalHandle: FileHandle?
+    /// Identifiers whose access time changed since it was last journaled
+    private var dirtyAccess: Set<String> = []
+    private let accessBatchSize = 32
+    /// Journal records tolerated before compaction, at least this many or twice the index size
+    private let minCompactionThreshold = 1000
+
+    private let encoder = JSONEncoder()
+    private let decoder = JSONDecoder()
+
+    /// One journal line: a put, or a removal when `entry` is nil
+    private struct JournalRecord: Codable {
+        let id: String
+        let entry: StorageIndexEntry?
+    }
+
+    /// - Parameters:
+    ///   - directory: Storage directory, index files are hidden files inside it
+    ///   - ignoredSuffixes: File suffixes of non image files (sidecars) in the directory
+    ///   - packedEntries: Images stored in pack segments, for rebuilds
+    init(
+        directory: URL,
+        ignoredSuffixes: [String] = [],
+        packedEntries: (() -> [(identifier: String, entry: StorageIndexEntry)])? = nil
+    ) {
+        self.directory = directory
+        self.ignoredSuffixes = ignoredSuffixes
+        self.packedEntries = packedEntries
+    }
+
+    deinit {
+        try? journalHandle?.close()
+    }
+
+    // MARK: - Lookup
+
+    func entry(for identifier: String) -> StorageIndexEntry? {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        return entries[identifier]
+    }
+
+    /// Record a read of a stored image
+    func touch(_ identifier: String, at date: Date = Date()) {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        guard entries[identifier] != nil else { return }
+        entries[identifier]?.lastAccess = date
+        entries[identifier]?.accessCount += 1
+        dirtyAccess.insert(identifier)
+        if dirtyAccess.count >= accessBatchSize {
+            flushAccessUnsafe()
+        }
+    }
+
+    var count: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        return entries.count
+    }
+
+    /// Bytes of every indexed image
+    var totalSize: Int64 {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        return _totalSize
+    }
+
+    /// Entries to evict first, O(n log n)
+    /// - Parameters:
+    ///   - limit: Number of entries wanted
+    ///   - policy: LRU: oldest access first, LFU: fewest reads first, oldest access among equals
+    func evictionCandidates(limit: Int, policy: IDStorageEvictionPolicy) -> [(identifier: String, entry: StorageIndexEntry)] {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+
+        let sorted = entries.sorted { lhs, rhs in
+            if policy == .lfu, lhs.value.accessCount != rhs.value.accessCount {
+                return lhs.value.accessCount < rhs.value.accessCount
+            }
+            return lhs.value.lastAccess < rhs.value.lastAccess
+        }
+        return sorted.prefix(limit).map { ($0.key, $0.value) }
+    }
+
+    // MARK: - Mutation
+
+    /// Index a written image file, or a record appended to a pack segment when `packOffset` is set
+    func put(_ identifier: String, relativePath: String, packOffset: Int64? = nil, size: Int64, format: ImageFormat?) {
+        let entry = StorageIndexEntry(
+            relativePath: relativePath,
+            packOffset: packOffset,
+            size: size,
+            lastAccess: Date(),
+            accessCount: 0,
+            format: format?.rawValue
+        )
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        _totalSize += entry.size - (entries[identifier]?.size ?? 0)
+        entries[identifier] = entry
+        dirtyAccess.remove(identifier)
+        appendUnsafe([JournalRecord(id: identifier, entry: entry)])
+    }
+
+    func remove(_ identifier: String) {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        guard let removed = entries.removeValue(forKey: identifier) else { return }
+        _totalSize -= removed.size
+        dirtyAccess.remove(identifier)
+        appendUnsafe([JournalRecord(id: identifier, entry: nil)])
+    }
+
+    /// Remove an eviction candidate, unless it was read or rewritten since it was picked
+    /// - Returns: true if removed
+    func remove(_ identifier: String, ifUnchangedSince candidate: StorageIndexEntry) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard let current = entries[identifier],
+              current.lastAccess == candidate.lastAccess,
+              current.relativePath == candidate.relativePath,
+              current.packOffset == candidate.packOffset else {
+            return false
+        }
+        entries.removeValue(forKey: identifier)
+        _totalSize -= current.size
+        dirtyAccess.remove(identifier)
+        appendUnsafe([JournalRecord(id: identifier, entry: nil)])
+        return true
+    }
+
+    /// Point a packed image at the copy made by a pack compaction
+    /// - Returns: false when the image was removed or rewritten since, the copy is then unused
+    func relocate(_ identifier: String, from old: (relativePath: String, packOffset: Int64), to new: (relativePath: String, packOffset: Int64)) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        loadIfNeeded()
+        guard let current = entries[identifier],
+              current.relativePath == old.relativePath,
+              current.packOffset == old.packOffset else {
+            return false
+        }
+        entries[identifier]?.relativePath = new.relativePath
+        entries[identifier]?.packOffset = new.packOffset
+        dirtyAccess.remove(identifier)
+        appendUnsafe([JournalRecord(id: identifier, entry: entries[identifier])])
+        return true
+    }
+
+    /// Forget every entry, used after the storage directory (with the index files) was deleted
+    func reset() {
+        lock.lock()
+        defer { lock.unlock() }
+        try? journalHandle?.close()
+        journalHandle = nil
+        entries.removeAll()
+        _totalSize = 0
+        dirtyAccess.removeAll()
+        journalCount = 0
+        isLoaded = true
+    }
+
+    /// Persist pending access times and compact the journal into a snapshot
+    func flush() {
+        lock.lock()
+        defer { lock.unlock() }
+        guard isLoaded, journalCount > 0 || !dirtyAccess.isEmpty else { return }
+        writeSnapshotUnsafe()
+    }
+
+    // MARK: - Journal
+
+    private var snapshotURL: URL {
+        directory.appendingPathComponent(Self.snapshotFileName)
+    }
+
+    private var journalURL: URL {
+        directory.appendingPathComponent(Self.journalFileName)
+    }
+
+    private func flushAccessUnsafe() {
+        let records = dirtyAccess.compactMap { id in
+            entries[id].map { JournalRecord(id: id, entry: $0) }
+        }
+        dirtyAccess.removeAll()
+        appendUnsafe(records)
+    }
+
+    private func appendUnsafe(_ records: [JournalRecord]) {
+        guard !records.isEmpty else { return }
+
+        var data = Data()
+        for record in records {
+            guard let line = try? encoder.encode(record) else { continue }
+            data.append(line)
+            data.append(0x0A)
+        }
+
+        if !writeJournalUnsafe(data) {
+            // Stale handle (journal replaced behind the index), reopen once
+            try? journalHandle?.close()
+            journalHandle = nil
+            guard writeJournalUnsafe(data) else { return }
+        }
+
+        journalCount += records.count
+        if journalCount >= max(minCompactionThreshold, entries.count * 2) {
+            writeSnapshotUnsafe()
+        }
+    }
+
+    /// Append to the journal, opened once and kept open until `reset()` or the next snapshot
+    private func writeJournalUnsafe(_ data: Data) -> Bool {
+        if journalHandle == nil {
+            if !fileManager.fileExists(atPath: journalURL.path) {
+                fileManager.createFile(atPath: journalURL.path, contents: nil)
+            }
+            journalHandle = try? FileHandle(forWritingTo: journalURL)
+            _ = try? journalHandle?.compatSeekToEnd()
+        }
+        guard let handle = journalHandle else { return false }
+        return (try? handle.compatWrite(data)) != nil
+    }
+
+    /// Write every entry to the snapshot and empty the journal
+    private func writeSnapshotUnsafe() {
+        dirtyAccess.removeAll()
+        guard let data = try? encoder.encode(entries),
+              (try? data.write(to: snapshotURL, options: .atomic)) != nil else {
+            return
+        }
+        try? journalHandle?.close()
+        journalHandle = nil
+        try? fileManager.removeItem(at: journalURL)
+        journalCount = 0
+    }
+
+    // MARK: - Loading
+
+    private func loadIfNeeded() {
+        guard !isLoaded else { return }
+        isLoaded = true
+
+        guard fileManager.fileExists(atPath: snapshotURL.path) || fileManager.fileExists(atPath: journalURL.path),
+              let loaded = loadFromFiles() else {
+            rebuildFromDirectoryUnsafe()
+            return
+        }
+        entries = loaded.entries
+        journalCount = loaded.journalCount
+        _totalSize = entries.values.reduce(0) { $0 + $1.size }
+    }
+
+    /// Snapshot plus journal replay
+    /// - Returns: nil when a file is corrupted (a torn last journal line is only dropped)
+    private func loadFromFiles() -> (entries: [String: StorageIndexEntry], journalCount: Int)? {
+        var loaded: [String: StorageIndexEntry] = [:]
+        if let data = try? Data(contentsOf: snapshotURL) {
+            guard let snapshot = try? decoder.decode([String: StorageIndexEntry].self, from: data) else {
+                return nil
+            }
+            loaded = snapshot
+        }
+
+        guard let journal = try? Data(contentsOf: journalURL) else {
+            return (loaded, 0)
+        }
+        let lines = journal.split(separator: 0x0A, omittingEmptySubsequences: true)
+        var count = 0
+        for (index, line) in lines.enumerated() {
+            guard let record = try? decoder.decode(JournalRecord.self, from: Data(line)) else {
+                // Crash while appending: only the unterminated last record may be torn
+                if index == lines.count - 1, journal.last != 0x0A {
+                    break
+                }
+                return nil
+            }
+            loaded[record.id] = record.entry
+            count += 1
+        }
+        return (loaded, count)
+    }
+
+    /// Index every image file of the storage directory, then persist a fresh snapshot
+    /// Identifiers are recovered from file names (`<identifier>.<ext>` or `<identifier>_<name>`),
+    /// as written by the built-in path providers
+    private func rebuildFromDirectoryUnsafe() {
+        entries.removeAll()
+        let keys: [URLResourceKey] = [.isRegularFileKey, .fileSizeKey, .contentAccessDateKey]
+        guard let enumerator = fileManager.enumerator(
+            at: directory,
+            includingPropertiesForKeys: keys,
+            options: [.skipsHiddenFiles]
+        ) else {
+            return
+        }
+
+        let basePath = directory.standardizedFileURL.path
+        for case let fileURL as URL in enumerator {
+            guard let values = try? fileURL.resourceValues(forKeys: Set(keys)),
+                  values.isRegularFile == true else { continue }
+            let fileName = fileURL.lastPathComponent
+            guard !ignoredSuffixes.contains(where: { fileName.hasSuffix($0) }),
+                  let identifier = fileName.split(whereSeparator: { $0 == "." || $0 == "_" }).first else {
+                continue
+            }
+
+            var relativePath = fileURL.standardizedFileURL.path
+            if relativePath.hasPrefix(basePath + "/") {
+                relativePath.removeFirst(basePath.count + 1)
+            }
+            entries[String(identifier)] = StorageIndexEntry(
+                relativePath: relativePath,
+                packOffset: nil,
+                size: Int64(values.fileSize ?? 0),
+                lastAccess: values.contentAccessDate ?? Date(),
+                accessCount: 0,
+                format: sniffFormat(of: fileURL)?.rawValue
+            )
+        }
+        // Packed images are in hidden segments, skipped above
+        for packed in packedEntries?() ?? [] {
+            entries[packed.identifier] = packed.entry
+        }
+
+        _totalSize = entries.values.reduce(0) { $0 + $1.size }
+        if fileManager.fileExists(atPath: directory.path) {
+            writeSnapshotUnsafe()
+        }
+    }
+
+    private func sniffFormat(of fileURL: URL) -> ImageFormat? {
+        guard let handle = try? FileHandle(forReadingFrom: fileURL) else { return nil }
+        defer { try? handle.close() }
+        guard let header = try? handle.compatRead(upToCount: 12) else { return nil }
+        return ImageFormat(data: header)
+    }
+}
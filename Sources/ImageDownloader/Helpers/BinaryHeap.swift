@@ -0,0 +1,82 @@
+//
+//  BinaryHeap.swift
+//  ImageDownloader
+//
+//  Array backed binary min-heap
+//
+
+import Foundation
+
+/// Binary min-heap ordered by `areInIncreasingOrder`, O(log n) push and pop
+/// Not thread safe, callers guard it with their own lock / queue
+internal struct BinaryHeap<Element> {
+    private var storage: [Element] = []
+    private let areInIncreasingOrder: (Element, Element) -> Bool
+
+    init(areInIncreasingOrder: @escaping (Element, Element) -> Bool) {
+        self.areInIncreasingOrder = areInIncreasingOrder
+    }
+
+    var count: Int {
+        storage.count
+    }
+
+    var isEmpty: Bool {
+        storage.isEmpty
+    }
+
+    /// Smallest element
+    var first: Element? {
+        storage.first
+    }
+
+    mutating func push(_ element: Element) {
+        storage.append(element)
+        siftUp(from: storage.count - 1)
+    }
+
+    /// Remove and return smallest element
+    mutating func pop() -> Element? {
+        guard !storage.isEmpty else { return nil }
+        storage.swapAt(0, storage.count - 1)
+        let element = storage.removeLast()
+        if !storage.isEmpty {
+            siftDown(from: 0)
+        }
+        return element
+    }
+
+    mutating func removeAll() {
+        storage.removeAll()
+    }
+
+    // MARK: - Private
+
+    private mutating func siftUp(from index: Int) {
+        var child = index
+        while child > 0 {
+            let parent = (child - 1) / 2
+            guard areInIncreasingOrder(storage[child], storage[parent]) else { return }
+            storage.swapAt(child, parent)
+            child = parent
+        }
+    }
+
+    private mutating func siftDown(from index: Int) {
+        var parent = index
+        while true {
+            let left = 2 * parent + 1
+            let right = left + 1
+            var smallest = parent
+            if left < storage.count, areInIncreasingOrder(storage[left], storage[smallest]) {
+                smallest = left
+            }
+            if right < storage.count, areInIncreasingOrder(storage[right], storage[smallest]) {
+                smallest = right
+            }
+            guard smallest != parent else { return }
+            storage.swapAt(parent, smallest)
+            parent = smallest
+        }
+    }
+}
@@ -0,0 +1,39 @@
+//
+//  FileHandle+Compat.swift
+//  ImageDownloader
+//
+//  Throwing FileHandle I/O on iOS 13.0
+//
+
+import Foundation
+
+/// The throwing `seekToEnd()`, `write(contentsOf:)` and `read(upToCount:)` need iOS 13.4,
+/// older systems fall back to the Objective-C calls (which raise instead of throwing)
+internal extension FileHandle {
+    /// Move to the end of the file
+    /// - Returns: The new offset
+    @discardableResult
+    func compatSeekToEnd() throws -> UInt64 {
+        if #available(iOS 13.4, macOS 10.15.4, *) {
+            return try seekToEnd()
+        }
+        return seekToEndOfFile()
+    }
+
+    func compatWrite(_ data: Data) throws {
+        if #available(iOS 13.4, macOS 10.15.4, *) {
+            try write(contentsOf: data)
+        } else {
+            write(data)
+        }
+    }
+
+    /// Up to `count` bytes from the current offset, nil at end of file
+    func compatRead(upToCount count: Int) throws -> Data? {
+        if #available(iOS 13.4, macOS 10.15.4, *) {
+            return try read(upToCount: count)
+        }
+        let data = readData(ofLength: count)
+        return data.isEmpty ? nil : data
+    }
+}
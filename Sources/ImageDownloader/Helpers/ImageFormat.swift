@@ -0,0 +1,55 @@
+//
+//  ImageFormat.swift
+//  ImageDownloader
+//
+//  Image container format sniffed from magic bytes
+//
+
+import Foundation
+
+/// Container format of encoded image data, detected from its first bytes
+internal enum ImageFormat: String {
+    case jpeg
+    case png
+    case gif
+    case webp
+    case heic
+    case tiff
+    case bmp
+
+    /// Detect the format of encoded data
+    /// - Returns: nil when the data is not a known image format (HTML error page, truncated body...)
+    init?(data: Data) {
+        guard data.count >= 12 else { return nil }
+        let bytes = [UInt8](data.prefix(12))
+
+        switch bytes[0] {
+        case 0xFF where bytes[1] == 0xD8 && bytes[2] == 0xFF:
+            self = .jpeg
+        case 0x89 where bytes[1...7].elementsEqual([0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A]):
+            self = .png
+        case 0x47 where bytes[1...3].elementsEqual([0x49, 0x46, 0x38]):
+            // "GIF8"
+            self = .gif
+        case 0x52 where bytes[1...3].elementsEqual([0x49, 0x46, 0x46])
+            && bytes[8...11].elementsEqual([0x57, 0x45, 0x42, 0x50]):
+            // "RIFF" .... "WEBP"
+            self = .webp
+        case 0x49 where bytes[1...3].elementsEqual([0x49, 0x2A, 0x00]),
+             0x4D where bytes[1...3].elementsEqual([0x4D, 0x00, 0x2A]):
+            // "II*\0" little endian, "MM\0*" big endian
+            self = .tiff
+        case 0x42 where bytes[1] == 0x4D:
+            // "BM"
+            self = .bmp
+        default:
+            // ISO BMFF: "ftyp" box at offset 4 followed by a HEIF brand
+            guard bytes[4...7].elementsEqual([0x66, 0x74, 0x79, 0x70]),
+                  let brand = String(bytes: bytes[8...11], encoding: .ascii),
+                  ["heic", "heix", "hevc", "hevx", "mif1", "msf1"].contains(brand) else {
+                return nil
+            }
+            self = .heic
+        }
+    }
+}
@@ -0,0 +1,218 @@
+//
+//  InFlightRequest.swift
+//  ImageDownloader
+//
+//  One shared cache -> storage -> network -> decode operation per URL
+//
+
+import Foundation
+import UIKit
+
+/// Shared in-flight operation for one URL
+/// Every concurrent `requestImage` for the same URL subscribes to the same operation,
+/// so N callers cost one storage read, one download and one decode
+internal final class InFlightRequest {
+    struct Subscriber {
+        /// Weak caller, nil when the request was made without caller (always delivered)
+        let caller: WeakBox<AnyObject>?
+        let completion: ImageCompletionBlock?
+        let progress: ImageProgressBlock?
+        let partialImage: ImagePartialBlock?
+
+        /// False once a caller that was given has been deallocated
+        var isAlive: Bool {
+            guard let caller = caller else { return true }
+            return caller.value != nil
+        }
+    }
+
+    let url: URL
+
+    private let lock = NSLock()
+    private var subscribers: [Subscriber] = []
+    private var _priority: DownloadPriority
+    private var _deadline: Date?
+    /// Network download of the operation, set once it started
+    private var _networkToken: DownloadToken?
+    private var _isAbandoned = false
+
+    init(url: URL, priority: DownloadPriority, deadline: Date? = nil) {
+        self.url = url
+        self._priority = priority
+        self._deadline = deadline
+    }
+
+    /// Queue deadline of the shared download: the latest one of the subscribers,
+    /// nil (default timeout) as soon as one subscriber has none
+    var deadline: Date? {
+        lock.lock()
+        defer { lock.unlock() }
+        return _deadline
+    }
+
+    /// Keep the shared download queued at least until a new subscriber's deadline
+    /// - Returns: true if the deadline moved
+    func extendDeadline(to deadline: Date?) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard let current = _deadline else { return false }
+        guard let deadline = deadline else {
+            _deadline = nil
+            return true
+        }
+        guard deadline > current else { return false }
+        _deadline = deadline
+        return true
+    }
+
+    /// Download priority of the shared operation
+    var priority: DownloadPriority {
+        lock.lock()
+        defer { lock.unlock() }
+        return _priority
+    }
+
+    /// Set priority of the shared operation
+    func updatePriority(_ priority: DownloadPriority) {
+        lock.lock()
+        _priority = priority
+        lock.unlock()
+    }
+
+    /// Inherit priority of a more urgent subscriber
+    /// - Returns: true if the priority was raised
+    func raisePriority(to priority: DownloadPriority) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard priority.isHigher(than: _priority) else { return false }
+        _priority = priority
+        return true
+    }
+
+    func addSubscriber(
+        caller: AnyObject?,
+        completion: ImageCompletionBlock?,
+        progress: ImageProgressBlock?,
+        partialImage: ImagePartialBlock? = nil
+    ) {
+        let subscriber = Subscriber(
+            caller: caller.map { WeakBox($0) },
+            completion: completion,
+            progress: progress,
+            partialImage: partialImage
+        )
+        lock.lock()
+        subscribers.append(subscriber)
+        lock.unlock()
+    }
+
+    /// Remove every subscriber of a caller, they are completed with `.cancelled`
+    /// - Returns: Number of live subscribers left
+    func removeSubscribers(of caller: AnyObject) -> Int {
+        lock.lock()
+        let removed = subscribers.filter { $0.caller?.value === caller }
+        subscribers.removeAll { $0.caller?.value === caller }
+        let remaining = subscribers.filter { $0.isAlive }.count
+        lock.unlock()
+
+        if !removed.isEmpty {
+            DispatchQueue.main.async {
+                for subscriber in removed {
+                    subscriber.completion?(nil, ImageDownloaderError.cancelled, false, false)
+                }
+            }
+        }
+        return remaining
+    }
+
+    /// Network download of the operation, nil before it started
+    var networkToken: DownloadToken? {
+        lock.lock()
+        defer { lock.unlock() }
+        return _networkToken
+    }
+
+    /// Remember the network download, so cancelling the last subscriber can cancel it
+    /// - Returns: false when the operation was abandoned meanwhile, the download must be cancelled
+    func attachNetworkToken(_ token: DownloadToken) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard !_isAbandoned else { return false }
+        _networkToken = token
+        return true
+    }
+
+    /// Set once every subscriber cancelled, the operation must not start more work
+    var isAbandoned: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return _isAbandoned
+    }
+
+    /// Abandon the operation if no live subscriber is left
+    /// - Returns: true if abandoned
+    func abandonIfUnused() -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard !subscribers.contains(where: { $0.isAlive }) else { return false }
+        _isAbandoned = true
+        return true
+    }
+
+    /// Drop subscribers whose caller is gone
+    /// - Returns: Number of subscribers left
+    @discardableResult
+    func removeDeadSubscribers() -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        subscribers.removeAll { !$0.isAlive }
+        return subscribers.count
+    }
+
+    /// Fan out progress to live subscribers on main thread
+    func notifyProgress(_ progress: DownloadProgress) {
+        lock.lock()
+        let current = subscribers
+        lock.unlock()
+
+        DispatchQueue.main.async {
+            for subscriber in current where subscriber.isAlive {
+                subscriber.progress?(CGFloat(progress.progress), CGFloat(progress.speed), CGFloat(progress.bytesDownloaded))
+            }
+        }
+    }
+
+    /// Whether a live subscriber wants intermediate frames, progressive decoding is skipped otherwise
+    var wantsPartialImages: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return subscribers.contains { $0.partialImage != nil && $0.isAlive }
+    }
+
+    /// Fan out an intermediate frame to live subscribers on main thread
+    func notifyPartialImage(_ image: UIImage) {
+        lock.lock()
+        let current = subscribers
+        lock.unlock()
+
+        DispatchQueue.main.async {
+            for subscriber in current where subscriber.isAlive {
+                subscriber.partialImage?(image)
+            }
+        }
+    }
+
+    /// Fan out the final result to every live subscriber on main thread, exactly once
+    func finish(image: UIImage?, error: Error?, fromCache: Bool, fromStorage: Bool) {
+        lock.lock()
+        let current = subscribers
+        subscribers.removeAll()
+        lock.unlock()
+
+        DispatchQueue.main.async {
+            for subscriber in current where subscriber.isAlive {
+                subscriber.completion?(image, error, fromCache, fromStorage)
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+//
+//  ResourceValidators.swift
+//  ImageDownloader
+//
+//  HTTP cache validators of a stored image
+//
+
+import Foundation
+
+/// HTTP validators and freshness of a stored image, persisted next to the image by StorageAgent
+/// Used to revalidate with `If-None-Match` / `If-Modified-Since` instead of downloading the body again
+struct ResourceValidators: Codable {
+    var etag: String?
+    var lastModified: String?
+    /// `Cache-Control: max-age`, nil when the server did not send one
+    var maxAge: TimeInterval?
+    /// When the response was stored or last revalidated
+    var storedAt: Date
+    /// Size of the body the validators describe, what a 304 saves
+    var contentLength: Int64
+
+    /// - Returns: nil when the response has nothing to revalidate with or forbids storing
+    init?(response: HTTPURLResponse, contentLength: Int64, now: Date = Date()) {
+        let cacheControl = response.value(forHTTPHeaderField: "Cache-Control")?.lowercased() ?? ""
+        if cacheControl.contains("no-store") {
+            return nil
+        }
+
+        self.etag = response.value(forHTTPHeaderField: "ETag")
+        self.lastModified = response.value(forHTTPHeaderField: "Last-Modified")
+        self.maxAge = cacheControl.contains("no-cache") ? 0 : Self.maxAge(in: cacheControl)
+        self.storedAt = now
+        self.contentLength = contentLength
+
+        guard etag != nil || lastModified != nil || maxAge != nil else { return nil }
+    }
+
+    /// Whether the server can answer 304 for this resource
+    var canRevalidate: Bool {
+        etag != nil || lastModified != nil
+    }
+
+    /// Whether both send the same conditional headers, so a 304 means the same to both
+    func hasSameConditions(as other: ResourceValidators) -> Bool {
+        etag == other.etag && lastModified == other.lastModified
+    }
+
+    /// Fresh resources are served from storage without asking the server
+    /// Lifetime is `max-age`, else 10% of the age since `Last-Modified` (capped to a day), else 0
+    func isFresh(at now: Date = Date()) -> Bool {
+        return now.timeIntervalSince(storedAt) < freshnessLifetime
+    }
+
+    /// Add conditional headers to a request
+    func apply(to request: inout URLRequest) {
+        if let etag = etag {
+            request.setValue(etag, forHTTPHeaderField: "If-None-Match")
+        }
+        if let lastModified = lastModified {
+            request.setValue(lastModified, forHTTPHeaderField: "If-Modified-Since")
+        }
+    }
+
+    /// Validators after a 304, headers sent with the 304 replace the stored ones
+    func refreshed(with response: HTTPURLResponse, now: Date = Date()) -> ResourceValidators {
+        var refreshed = self
+        refreshed.storedAt = now
+        if let etag = response.value(forHTTPHeaderField: "ETag") {
+            refreshed.etag = etag
+        }
+        if let lastModified = response.value(forHTTPHeaderField: "Last-Modified") {
+            refreshed.lastModified = lastModified
+        }
+        if let cacheControl = response.value(forHTTPHeaderField: "Cache-Control")?.lowercased() {
+            refreshed.maxAge = cacheControl.contains("no-cache") ? 0 : Self.maxAge(in: cacheControl)
+        }
+        return refreshed
+    }
+
+    // MARK: - Private
+
+    private var freshnessLifetime: TimeInterval {
+        if let maxAge = maxAge {
+            return maxAge
+        }
+        if let lastModified = lastModified,
+           let lastModifiedDate = Self.httpDateFormatter.date(from: lastModified) {
+            let age = storedAt.timeIntervalSince(lastModifiedDate)
+            return min(max(age * 0.1, 0), 24 * 60 * 60)
+        }
+        return 0
+    }
+
+    private static func maxAge(in cacheControl: String) -> TimeInterval? {
+        for directive in cacheControl.split(separator: ",") {
+            let parts = directive.split(separator: "=", maxSplits: 1)
+            guard parts.count == 2,
+                  parts[0].trimmingCharacters(in: .whitespaces) == "max-age",
+                  let seconds = TimeInterval(parts[1].trimmingCharacters(in: .whitespaces)) else { continue }
+            return seconds
+        }
+        return nil
+    }
+
+    private static let httpDateFormatter: DateFormatter = {
+        let formatter = DateFormatter()
+        formatter.locale = Locale(identifier: "en_US_POSIX")
+        formatter.timeZone = TimeZone(identifier: "GMT")
+        formatter.dateFormat = "EEE, dd MMM yyyy HH:mm:ss zzz"
+        return formatter
+    }()
+}
+
+/// Download result of a conditional request answered with 304 Not Modified
+/// Delivered as the error of the download, the stored image is still valid
+struct ResourceNotModified: Error {
+    let response: HTTPURLResponse
+}
@@ -14,6 +14,16 @@ import Foundation
     @objc public var highLatencyLimit: Int
     @objc public var lowLatencyLimit: Int
 
+    // MARK: - Memory Budget
+    /// Maximum decoded bytes (width * height * bytesPerPixel) kept in high latency cache, 0 = unlimited
+    @objc public var highLatencyMemoryLimit: Int
+    /// Maximum decoded bytes (width * height * bytesPerPixel) kept in low latency cache, 0 = unlimited
+    @objc public var lowLatencyMemoryLimit: Int
+
+    // MARK: - Eviction
+    /// Eviction policy used by both tiers (default: LRU)
+    @objc public var evictionPolicy: IDCacheEvictionPolicy
+
     // MARK: - Cache Behavior
     @objc public var clearLowPriorityOnMemoryWarning: Bool
     @objc public var clearAllOnMemoryWarning: Bool
@@ -23,11 +33,17 @@ import Foundation
     @objc public init(
         highLatencyLimit: Int = 50,
         lowLatencyLimit: Int = 100,
+        highLatencyMemoryLimit: Int = 50 * 1024 * 1024,
+        lowLatencyMemoryLimit: Int = 100 * 1024 * 1024,
+        evictionPolicy: IDCacheEvictionPolicy = .lru,
         clearLowPriorityOnMemoryWarning: Bool = true,
         clearAllOnMemoryWarning: Bool = false
     ) {
         self.highLatencyLimit = highLatencyLimit
         self.lowLatencyLimit = lowLatencyLimit
+        self.highLatencyMemoryLimit = highLatencyMemoryLimit
+        self.lowLatencyMemoryLimit = lowLatencyMemoryLimit
+        self.evictionPolicy = evictionPolicy
         self.clearLowPriorityOnMemoryWarning = clearLowPriorityOnMemoryWarning
         self.clearAllOnMemoryWarning = clearAllOnMemoryWarning
         super.init()
@@ -45,6 +61,9 @@ import Foundation
         return CacheConfig(
             highLatencyLimit: highLatencyLimit,
             lowLatencyLimit: lowLatencyLimit,
+            highLatencyMemoryLimit: highLatencyMemoryLimit,
+            lowLatencyMemoryLimit: lowLatencyMemoryLimit,
+            evictionPolicy: evictionPolicy,
             clearLowPriorityOnMemoryWarning: clearLowPriorityOnMemoryWarning,
             clearAllOnMemoryWarning: clearAllOnMemoryWarning
         )
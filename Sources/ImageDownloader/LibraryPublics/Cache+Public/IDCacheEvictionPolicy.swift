@@ -0,0 +1,17 @@
+//
+//  IDCacheEvictionPolicy.swift
+//  ImageDownloader
+//
+//  Objective-C compatible eviction policy selection
+//
+
+import Foundation
+
+/// Eviction policy used by each memory cache tier
+@objc public enum IDCacheEvictionPolicy: Int {
+    /// Plain least recently used queue (default)
+    case lru
+    /// Window-TinyLFU: small LRU window plus a frequency-filtered main space,
+    /// resists one-off scroll-through traffic flushing the hot set
+    case tinyLFU
+}
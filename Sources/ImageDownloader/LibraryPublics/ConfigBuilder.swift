@@ -24,6 +24,14 @@ public class ConfigBuilder {
         return self
     }
 
+    /// Slots a single host may use at once, below `maxConcurrentDownloads` to bind
+    /// (-1 = half of the concurrency window, 0 = no per host limit)
+    @discardableResult
+    public func maxConcurrentDownloadsPerHost(_ count: Int) -> Self {
+        networkConfig.maxConcurrentDownloadsPerHost = count
+        return self
+    }
+
     @discardableResult
     public func timeout(_ seconds: TimeInterval) -> Self {
         networkConfig.timeout = seconds
@@ -36,12 +44,55 @@ public class ConfigBuilder {
         return self
     }
 
+    /// Minimum seconds between two progress callbacks of a download (0 = every received chunk)
+    @discardableResult
+    public func progressInterval(_ seconds: TimeInterval) -> Self {
+        networkConfig.progressInterval = seconds
+        return self
+    }
+
+    /// Minimum seconds between two partial frames of a progressive download
+    @discardableResult
+    public func progressiveDecodingInterval(_ seconds: TimeInterval) -> Self {
+        networkConfig.progressiveDecodingInterval = seconds
+        return self
+    }
+
+    /// Bytes of interrupted downloads kept to resume them with range requests (0 = never resume)
+    @discardableResult
+    public func partialDownloadsMemoryLimit(_ bytes: Int) -> Self {
+        networkConfig.partialDownloadsMemoryLimit = bytes
+        return self
+    }
+
     @discardableResult
     public func retryPolicy(_ policy: IDRetryPolicy) -> Self {
         networkConfig.retryPolicy = policy.toSwift()
         return self
     }
 
+    /// Retries allowed per download, across all hosts (0.1 = at most 10% extra requests)
+    @discardableResult
+    public func retryBudgetRatio(_ ratio: Double) -> Self {
+        networkConfig.retryBudgetRatio = ratio
+        return self
+    }
+
+    /// Fail requests to a host fast for `openInterval` seconds after `failureThreshold` consecutive failures
+    @discardableResult
+    public func circuitBreaker(failureThreshold: Int, openInterval: TimeInterval) -> Self {
+        networkConfig.circuitBreakerFailureThreshold = failureThreshold
+        networkConfig.circuitBreakerOpenInterval = openInterval
+        return self
+    }
+
+    /// Seconds a 404 or repeated decode failure of a URL is remembered (0 = not remembered)
+    @discardableResult
+    public func negativeCacheTTL(_ seconds: TimeInterval) -> Self {
+        networkConfig.negativeCacheTTL = seconds
+        return self
+    }
+
     @discardableResult
     public func customHeaders(_ headers: [String: String]?) -> Self {
         networkConfig.customHeaders = headers
@@ -54,6 +105,55 @@ public class ConfigBuilder {
         return self
     }
 
+    /// Seconds a queued download has to wait to be served like one priority level higher
+    @discardableResult
+    public func priorityAgingInterval(_ seconds: TimeInterval) -> Self {
+        networkConfig.priorityAgingInterval = seconds
+        return self
+    }
+
+    /// Seconds a download may wait for a slot when the request has no deadline of its own
+    @discardableResult
+    public func pendingRequestTimeout(_ seconds: TimeInterval) -> Self {
+        networkConfig.pendingRequestTimeout = seconds
+        return self
+    }
+
+    /// Bound the downloads waiting for a slot, `policy` decides what is dropped when full
+    @discardableResult
+    public func maxPendingDownloads(_ count: Int, policy: IDQueueOverflowPolicy = .dropOldestLowPriority) -> Self {
+        networkConfig.maxPendingDownloads = count
+        networkConfig.pendingOverflowPolicy = policy
+        return self
+    }
+
+    /// Adjust the concurrency window between `min` and `max` from observed latency
+    /// `maxConcurrentDownloads` becomes the starting window
+    @discardableResult
+    public func adaptiveConcurrency(min: Int = 1, max: Int = 16) -> Self {
+        networkConfig.adaptiveConcurrency = true
+        networkConfig.minAdaptiveConcurrentDownloads = min
+        networkConfig.maxAdaptiveConcurrentDownloads = max
+        return self
+    }
+
+    /// Lower a download to `.low` instead of cancelling it when its last caller cancels
+    @discardableResult
+    public func deprioritizesCancelledDownloads(_ enable: Bool) -> Self {
+        networkConfig.deprioritizesCancelledDownloads = enable
+        return self
+    }
+
+    /// Hedge downloads still waiting for their first byte after the `percentile` of recent
+    /// time-to-first-byte, with at most `budgetRatio` extra requests per download
+    @discardableResult
+    public func hedging(percentile: Double = 0.95, budgetRatio: Double = 0.05) -> Self {
+        networkConfig.hedgingEnabled = true
+        networkConfig.hedgePercentile = percentile
+        networkConfig.hedgeBudgetRatio = budgetRatio
+        return self
+    }
+
     // MARK: - Cache Configuration
     /// Number of item will storage on cache (high latency cache)
     @discardableResult
@@ -69,6 +169,27 @@ public class ConfigBuilder {
         return self
     }
 
+    /// Maximum decoded bytes kept on cache (high latency cache), 0 = unlimited
+    @discardableResult
+    public func highLatencyMemoryLimit(_ bytes: Int) -> Self {
+        cacheConfig.highLatencyMemoryLimit = bytes
+        return self
+    }
+
+    /// Maximum decoded bytes kept on cache (low latency cache), 0 = unlimited
+    @discardableResult
+    public func lowLatencyMemoryLimit(_ bytes: Int) -> Self {
+        cacheConfig.lowLatencyMemoryLimit = bytes
+        return self
+    }
+
+    /// Eviction policy of both cache tiers (default: LRU)
+    @discardableResult
+    public func evictionPolicy(_ policy: IDCacheEvictionPolicy) -> Self {
+        cacheConfig.evictionPolicy = policy
+        return self
+    }
+
     @discardableResult
     public func clearLowPriorityOnMemoryWarning(_ clear: Bool) -> Self {
         cacheConfig.clearLowPriorityOnMemoryWarning = clear
@@ -95,6 +216,43 @@ public class ConfigBuilder {
         return self
     }
 
+    /// Revalidate stale stored images with the server (ETag / Last-Modified)
+    @discardableResult
+    public func revalidatesStoredImages(_ enable: Bool) -> Self {
+        storageConfig.revalidatesStoredImages = enable
+        return self
+    }
+
+    /// Store downloaded bytes as received (true) or re-encode them with the compression provider (false)
+    @discardableResult
+    public func storesOriginalData(_ enable: Bool) -> Self {
+        storageConfig.storesOriginalData = enable
+        return self
+    }
+
+    /// Disk budget of stored images (0 = unlimited), trimmed in the background in `policy` order
+    @discardableResult
+    public func storageLimit(bytes: Int = 0, fileCount: Int = 0, policy: IDStorageEvictionPolicy = .lru) -> Self {
+        storageConfig.maxStorageSize = bytes
+        storageConfig.maxFileCount = fileCount
+        storageConfig.evictionPolicy = policy
+        return self
+    }
+
+    /// Pack images up to `maxSize` bytes into shared segment files (0 = one file per image)
+    @discardableResult
+    public func packSmallImages(upTo maxSize: Int) -> Self {
+        storageConfig.packedImageMaxSize = maxSize
+        return self
+    }
+
+    /// Disk reads and writes running at the same time
+    @discardableResult
+    public func maxConcurrentStorageIO(_ count: Int) -> Self {
+        storageConfig.maxConcurrentIO = count
+        return self
+    }
+
     @discardableResult
     public func storagePath(_ path: String?) -> Self {
         storageConfig.storagePath = path
@@ -137,12 +295,34 @@ public class ConfigBuilder {
             allowsCellularAccess: networkConfig.allowsCellularAccess,
             retryPolicy: IDRetryPolicy(from: networkConfig.retryPolicy)
         )
+        network.maxConcurrentDownloadsPerHost = networkConfig.maxConcurrentDownloadsPerHost
         network.customHeaders = networkConfig.customHeaders
         network.authenticationHandler = networkConfig.authenticationHandler
+        network.priorityAgingInterval = networkConfig.priorityAgingInterval
+        network.pendingRequestTimeout = networkConfig.pendingRequestTimeout
+        network.maxPendingDownloads = networkConfig.maxPendingDownloads
+        network.pendingOverflowPolicy = networkConfig.pendingOverflowPolicy
+        network.progressInterval = networkConfig.progressInterval
+        network.progressiveDecodingInterval = networkConfig.progressiveDecodingInterval
+        network.partialDownloadsMemoryLimit = networkConfig.partialDownloadsMemoryLimit
+        network.retryBudgetRatio = networkConfig.retryBudgetRatio
+        network.circuitBreakerFailureThreshold = networkConfig.circuitBreakerFailureThreshold
+        network.circuitBreakerOpenInterval = networkConfig.circuitBreakerOpenInterval
+        network.negativeCacheTTL = networkConfig.negativeCacheTTL
+        network.adaptiveConcurrency = networkConfig.adaptiveConcurrency
+        network.minAdaptiveConcurrentDownloads = networkConfig.minAdaptiveConcurrentDownloads
+        network.maxAdaptiveConcurrentDownloads = networkConfig.maxAdaptiveConcurrentDownloads
+        network.deprioritizesCancelledDownloads = networkConfig.deprioritizesCancelledDownloads
+        network.hedgingEnabled = networkConfig.hedgingEnabled
+        network.hedgePercentile = networkConfig.hedgePercentile
+        network.hedgeBudgetRatio = networkConfig.hedgeBudgetRatio
 
         let cache = IDCacheConfig(
             highLatencyLimit: cacheConfig.highLatencyLimit,
             lowLatencyLimit: cacheConfig.lowLatencyLimit,
+            highLatencyMemoryLimit: cacheConfig.highLatencyMemoryLimit,
+            lowLatencyMemoryLimit: cacheConfig.lowLatencyMemoryLimit,
+            evictionPolicy: cacheConfig.evictionPolicy,
             clearLowPriorityOnMemoryWarning: cacheConfig.clearLowPriorityOnMemoryWarning,
             clearAllOnMemoryWarning: cacheConfig.clearAllOnMemoryWarning
         )
@@ -151,6 +331,13 @@ public class ConfigBuilder {
             shouldSaveToStorage: storageConfig.shouldSaveToStorage,
             storagePath: storageConfig.storagePath
         )
+        storage.revalidatesStoredImages = storageConfig.revalidatesStoredImages
+        storage.storesOriginalData = storageConfig.storesOriginalData
+        storage.maxStorageSize = storageConfig.maxStorageSize
+        storage.maxFileCount = storageConfig.maxFileCount
+        storage.evictionPolicy = storageConfig.evictionPolicy
+        storage.packedImageMaxSize = storageConfig.packedImageMaxSize
+        storage.maxConcurrentIO = storageConfig.maxConcurrentIO
 
         return IDConfiguration(
             network: network,
@@ -184,6 +371,8 @@ extension ConfigBuilder {
             .maxConcurrentDownloads(2)
             .lowLatencyLimit(20)
             .highLatencyLimit(50)
+            .lowLatencyMemoryLimit(20 * 1024 * 1024)
+            .highLatencyMemoryLimit(30 * 1024 * 1024)
             .clearLowPriorityOnMemoryWarning(true)
             .clearAllOnMemoryWarning(true)
     }
@@ -75,6 +75,11 @@ import Foundation
         set { network.retryPolicy = newValue }
     }
 
+    @objc public var deprioritizesCancelledDownloads: Bool {
+        get { network.deprioritizesCancelledDownloads }
+        set { network.deprioritizesCancelledDownloads = newValue }
+    }
+
     @objc public var customHeaders: [String: String]? {
         get { network.customHeaders }
         set { network.customHeaders = newValue }
@@ -97,6 +102,24 @@ import Foundation
         set { cache.lowLatencyLimit = newValue }
     }
 
+    /// Cache properties, remember, not set this variable when downloading, it can lead to un-exepted behavior
+    @objc public var highLatencyMemoryLimit: Int {
+        get { cache.highLatencyMemoryLimit }
+        set { cache.highLatencyMemoryLimit = newValue }
+    }
+
+    /// Cache properties, remember, not set this variable when downloading, it can lead to un-exepted behavior
+    @objc public var lowLatencyMemoryLimit: Int {
+        get { cache.lowLatencyMemoryLimit }
+        set { cache.lowLatencyMemoryLimit = newValue }
+    }
+
+    /// Cache properties, remember, not set this variable when downloading, it can lead to un-exepted behavior
+    @objc public var cacheEvictionPolicy: IDCacheEvictionPolicy {
+        get { cache.evictionPolicy }
+        set { cache.evictionPolicy = newValue }
+    }
+
     /// Cache properties, remember, not set this variable when downloading, it can lead to un-exepted behavior
     @objc public var clearLowPriorityOnMemoryWarning: Bool {
         get { cache.clearLowPriorityOnMemoryWarning }
@@ -120,6 +143,41 @@ import Foundation
         set { storage.storagePath = newValue }
     }
 
+    @objc public var revalidatesStoredImages: Bool {
+        get { storage.revalidatesStoredImages }
+        set { storage.revalidatesStoredImages = newValue }
+    }
+
+    @objc public var storesOriginalData: Bool {
+        get { storage.storesOriginalData }
+        set { storage.storesOriginalData = newValue }
+    }
+
+    @objc public var maxStorageSize: Int {
+        get { storage.maxStorageSize }
+        set { storage.maxStorageSize = newValue }
+    }
+
+    @objc public var maxStorageFileCount: Int {
+        get { storage.maxFileCount }
+        set { storage.maxFileCount = newValue }
+    }
+
+    @objc public var storageEvictionPolicy: IDStorageEvictionPolicy {
+        get { storage.evictionPolicy }
+        set { storage.evictionPolicy = newValue }
+    }
+
+    @objc public var packedImageMaxSize: Int {
+        get { storage.packedImageMaxSize }
+        set { storage.packedImageMaxSize = newValue }
+    }
+
+    @objc public var maxConcurrentStorageIO: Int {
+        get { storage.maxConcurrentIO }
+        set { storage.maxConcurrentIO = newValue }
+    }
+
     @objc public var identifierProvider: AnyObject? {
         get { storage.identifierProvider }
         set {
@@ -224,7 +282,9 @@ extension IDConfiguration {
         
         let cacheConfig = IDCacheConfig(
             highLatencyLimit: 20,
-            lowLatencyLimit: 50
+            lowLatencyLimit: 50,
+            highLatencyMemoryLimit: 20 * 1024 * 1024,
+            lowLatencyMemoryLimit: 30 * 1024 * 1024
         )
         
         return IDConfiguration(
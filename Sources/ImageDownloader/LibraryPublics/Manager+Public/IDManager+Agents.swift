@@ -6,6 +6,7 @@
 //
 
 import Foundation
+import UIKit
 
 // MARK: - Configuration function
 extension ImageDownloaderManager {
@@ -22,22 +23,49 @@ extension ImageDownloaderManager {
 // MARK: - Request image
 extension ImageDownloaderManager {
     // MARK: - Network
+    /// Cancel the request of one caller, completed with `.cancelled`
+    /// Other callers of the same URL keep loading, the shared download is only cancelled once its
+    /// last caller cancelled (or lowered to `.low` and kept, with `deprioritizesCancelledDownloads`)
+    /// - Parameter caller: nil cancels the URL for every caller, like `cancelAllRequests(for:)`
     @objc public func cancelRequest(for url: URL, caller: AnyObject?) {
-        // Note: caller parameter ignored in new actor-based implementation
-        // All callbacks for the same URL share the same Task
-        if caller != nil {
-            
+        guard let caller = caller else {
+            cancelAllRequests(for: url)
+            return
+        }
+        guard let request = inFlightRequest(for: url),
+              request.removeSubscribers(of: caller) == 0 else {
+            return
+        }
+
+        if configuration.deprioritizesCancelledDownloads {
+            // Still fills cache and storage, without competing with images on screen
+            request.updatePriority(.low)
+            networkAgent.updatePriority(for: url, to: .low)
         } else {
-            // Cancel all task
-            networkAgent.cancelDownload(for: url)
+            abandon(request)
         }
     }
     
     @objc public func cancelAllRequests(for url: URL) {
         networkAgent.cancelDownload(for: url)
     }
+
+    /// Raise or lower download priority of a URL that is already requested
+    /// Use it when cells scroll in or out of view: queued downloads are re-ordered,
+    /// running ones get their URLSessionTask priority updated
+    @objc public func updatePriority(_ priority: DownloadPriority, for url: URL) {
+        inFlightRequest(for: url)?.updatePriority(priority)
+        networkAgent.updatePriority(for: url, to: priority)
+    }
     
     // MARK: - Cache
+    /// Get image from memory cache synchronously on the calling thread
+    /// No Task, actor hop or main queue hop is involved, safe to call from `cellForItemAt`
+    /// - Returns: Cached image, or nil when it is not in memory
+    @objc public func cachedImage(for url: URL) -> UIImage? {
+        return cacheAgent.cachedImage(for: url)
+    }
+
     @objc public func clearCache(url: URL) {
         Task {
             await cacheAgent.clearCache(url: url)
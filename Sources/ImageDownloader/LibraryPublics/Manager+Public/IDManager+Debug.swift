@@ -24,6 +24,22 @@ public extension ImageDownloaderManager {
         }
     }
     
+    public func cacheBytesHighLatency() async -> Int {
+        if configuration.isDebug {
+            return await cacheAgent.highLatencyCacheCost()
+        } else {
+            return 0
+        }
+    }
+    
+    public func cacheBytesLowLatency() async -> Int {
+        if configuration.isDebug {
+            return await cacheAgent.lowLatencyCacheCost()
+        } else {
+            return 0
+        }
+    }
+    
     public func storageSizeBytes() -> UInt {
         if configuration.isDebug {
             return storageAgent.currentStorageSize()
@@ -56,4 +72,93 @@ public extension ImageDownloaderManager {
             return 0
         }
     }
+    
+    public func activeDownloadsCount(forHost host: String) async -> Int {
+        if configuration.isDebug {
+            return networkAgent.activeDownloadCount(forHost: host)
+        } else {
+            return 0
+        }
+    }
+    
+    public func queuedDownloadsCount(forHost host: String) async -> Int {
+        if configuration.isDebug {
+            return networkAgent.pendingDownloadCount(forHost: host)
+        } else {
+            return 0
+        }
+    }
+    
+    /// Active and queued downloads of every host that has work
+    public func downloadsCountByHost() async -> [String: (active: Int, queued: Int)] {
+        if configuration.isDebug {
+            return networkAgent.downloadCountsByHost.mapValues { (active: $0.active, queued: $0.pending) }
+        } else {
+            return [:]
+        }
+    }
+    
+    /// Stored images revalidated with a 304 Not Modified answer
+    public func revalidatedImagesCount() async -> Int {
+        if configuration.isDebug {
+            return networkAgent.revalidatedCount
+        } else {
+            return 0
+        }
+    }
+    
+    /// Body bytes not downloaded thanks to 304 Not Modified answers
+    public func revalidationBytesSaved() async -> Int64 {
+        if configuration.isDebug {
+            return networkAgent.revalidationBytesSaved
+        } else {
+            return 0
+        }
+    }
+    
+    /// Retries started, and retries refused because the retry budget was exhausted
+    public func retryCounts() async -> (allowed: Int, denied: Int) {
+        if configuration.isDebug {
+            return networkAgent.retryCounts
+        } else {
+            return (0, 0)
+        }
+    }
+    
+    /// Hedge requests sent, hedges that finished first, and their win rate (wins / hedges)
+    public func hedgeStatistics() async -> (issued: Int, wins: Int, winRate: Double) {
+        if configuration.isDebug {
+            let counts = networkAgent.hedgeCounts
+            let winRate = counts.issued > 0 ? Double(counts.wins) / Double(counts.issued) : 0
+            return (counts.issued, counts.wins, winRate)
+        } else {
+            return (0, 0, 0)
+        }
+    }
+    
+    /// Hosts whose requests currently fail fast (circuit open or probing)
+    public func unavailableHosts() async -> [String] {
+        if configuration.isDebug {
+            return networkAgent.unavailableHosts
+        } else {
+            return []
+        }
+    }
+    
+    /// URLs currently failing fast because they recently gave 404 or undecodable data
+    public func negativeCacheCount() async -> Int {
+        if configuration.isDebug {
+            return networkAgent.negativeCacheCount
+        } else {
+            return 0
+        }
+    }
+    
+    public func currentConcurrencyLimit() async -> Int {
+        if configuration.isDebug {
+            return networkAgent.currentConcurrencyLimit
+        } else {
+            return 0
+        }
+    }
 }
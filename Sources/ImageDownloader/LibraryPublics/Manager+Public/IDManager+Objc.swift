@@ -10,6 +10,8 @@ import UIKit
 
 public typealias ImageCompletionBlock = (UIImage?, Error?, Bool, Bool) -> Void
 public typealias ImageProgressBlock = (_ progress: CGFloat, _ speed: CGFloat, _ bytes: CGFloat) -> Void
+/// Intermediate lower quality frame of an image that is still downloading
+public typealias ImagePartialBlock = (UIImage) -> Void
 
 
 // MARK: - ObjectiveC Compatinble
@@ -22,62 +24,94 @@ extension ImageDownloaderManager {
     ///     self?.imageView.image = image
     /// }
     /// ```
-    @objc public func requestImage(
+    ///
+    /// Pass `partialImage` to get intermediate frames (progressive JPEG scans, interlaced PNG passes,
+    /// or the rows received so far) while the image downloads. Frames are only decoded for a download
+    /// started by a request that asked for them
+    ///
+    /// Pass `deadline` to fail with `.timeout` when the download is still waiting for a slot at that
+    /// date (nil = `pendingRequestTimeout`). A download shared by several requests waits for the latest one
+    @objc(requestImageAt:caller:updateLatency:downloadPriority:deadline:progress:partialImage:completion:)
+    public func requestImage(
         at url: URL,
         caller: AnyObject? = nil,
         updateLatency latency: ResourceUpdateLatency = .high,
         downloadPriority: DownloadPriority = .high,
+        deadline: Date? = nil,
         progress: ImageProgressBlock? = nil,
+        partialImage: ImagePartialBlock? = nil,
         completion: ImageCompletionBlock? = nil
     ) {
-        // Wrap callbacks to ensure they run on main thread only
-        let mainThreadCompletion: ImageCompletionBlock? = completion.map { block in
-            return { image, error, fromCache, fromStorage in
-                DispatchQueue.main.async { block(image, error, fromCache, fromStorage) }
+        // Hot path: memory hit is served without spawning a Task
+        if let image = cacheAgent.cachedImage(for: url) {
+            if Thread.isMainThread {
+                completion?(image, nil, true, false)
+            } else if let completion = completion {
+                DispatchQueue.main.async { completion(image, nil, true, false) }
             }
+            return
         }
 
+        // Coalesce: only the first request for a URL runs the pipeline, others subscribe to it
+        let (request, isNew) = subscribe(
+            url: url,
+            caller: caller,
+            priority: downloadPriority,
+            deadline: deadline,
+            completion: completion,
+            progress: progress,
+            partialImage: partialImage
+        )
+        guard isNew else { return }
+
         Task {
             let cacheResult = await self.cacheAgent.image(for: url)
             switch cacheResult {
             case .hit(let image):
-                if configuration.shouldSaveToStorage,
-                   self.storageAgent.image(for: url) == nil {
-                    self.storageAgent.saveImage(image, for: url)
-                } else if false {
-                    // FIXME: Check re-insertion logic (check same image, nil image)
-                }
-                mainThreadCompletion?(image, nil, true, false)
-            case .wait:
-                if let completion = mainThreadCompletion {
-                    registerCaller(
-                        url: url,
-                        caller: caller,
-                        completion: completion,
-                        progress: progress
-                    )
+                // Only a copy of the cached image, dropped when storage reads pile up
+                if configuration.shouldSaveToStorage {
+                    self.storageAgent.scheduleSaveImage(image, for: url, onlyIfMissing: true, isDiscardable: true)
                 }
-                return
+                finish(request, image: image, error: nil, fromCache: true, fromStorage: false)
 
             case .miss:
                 /// **LOGIC NOTE**: only check from storage if config allow save to storage, if not, just jump straight to fetch to download
+                // Disk reads run on the storage I/O executor, never blocking this task's thread
                 if configuration.shouldSaveToStorage,
-                   let storageImage = self.storageAgent.image(for: url) {
+                   let storageImage = await self.storageAgent.loadImage(for: url) {
                     await self.cacheAgent.setImage(storageImage, for: url, isHighLatency: latency.isHighLatency)
-                    mainThreadCompletion?(storageImage, nil, false, true)
+                    finish(request, image: storageImage, error: nil, fromCache: false, fromStorage: true)
+                    // Stale-while-revalidate: the stored image is already served, refresh it in background
+                    await revalidateIfNeeded(url, latency: latency)
                 } else {
-                    downloadFromNetworkThenUpdate(
-                        at: url,
-                        downloadPriority: downloadPriority,
-                        latency: latency,
-                        progress: progress,
-                        completion: mainThreadCompletion
-                    )
+                    downloadFromNetworkThenUpdate(request, latency: latency)
                 }
             }
         }
     }
     
+    /// Selector of the original API (`requestImageAt:caller:updateLatency:downloadPriority:progress:completion:`),
+    /// kept for existing Objective-C callers; no deadline and no partial frames
+    @objc public func requestImage(
+        at url: URL,
+        caller: AnyObject?,
+        updateLatency latency: ResourceUpdateLatency,
+        downloadPriority: DownloadPriority,
+        progress: ImageProgressBlock?,
+        completion: ImageCompletionBlock?
+    ) {
+        requestImage(
+            at: url,
+            caller: caller,
+            updateLatency: latency,
+            downloadPriority: downloadPriority,
+            deadline: nil,
+            progress: progress,
+            partialImage: nil,
+            completion: completion
+        )
+    }
+
     /// Simplified API with default parameters, fast, call this again to
     @objc public func requestImage(
         at url: URL,
@@ -93,28 +127,45 @@ extension ImageDownloaderManager {
     
     // MARK: - Private func for objective c selector
     private func downloadFromNetworkThenUpdate (
-        at url: URL,
-        downloadPriority: DownloadPriority,
-        latency: ResourceUpdateLatency,
-        progress: ImageProgressBlock? = nil,
-        completion: ImageCompletionBlock? = nil
+        _ request: InFlightRequest,
+        latency: ResourceUpdateLatency
     ) {
-        // Convert DownloadProgress to simple CGFloat for backward compatibility
-        let progressAdapter: DownloadProgressHandler? = progress.map { progressBlock in
-            return { downloadProgress in
-                DispatchQueue.main.async {
-                    progressBlock(CGFloat(downloadProgress.progress), CGFloat(downloadProgress.speed), CGFloat(downloadProgress.bytesDownloaded))
-                }
-            }
+        let url = request.url
+
+        // Every subscriber cancelled while cache and storage were checked
+        if request.isAbandoned {
+            finish(request, image: nil, error: ImageDownloaderError.cancelled, fromCache: false, fromStorage: false)
+            return
         }
 
         // Download and decode image from network (NetworkAgent now returns UIImage)
-        networkAgent.downloadData(at: url, priority: downloadPriority, progress: progressAdapter) { [weak self] image, error in
+        // Progressive decoding costs a decode per frame, only run it when someone shows the frames
+        let partialImage: DownloadPartialImageHandler? = request.wantsPartialImages
+            ? { frame in request.notifyPartialImage(frame) }
+            : nil
+        // Set before completion, persisted with the image for later revalidation
+        var validators: ResourceValidators?
+        // Original bytes are written while they are decoded, instead of re-encoding the image afterwards
+        let storesOriginalData = configuration.shouldSaveToStorage && configuration.storesOriginalData
+        let originalData: DownloadDataHandler? = storesOriginalData
+            ? { [weak self] data in self?.storageAgent.scheduleSaveImageData(data, for: url, validators: validators) }
+            : nil
+
+        let token = networkAgent.downloadData(at: url, priority: request.priority, progress: { downloadProgress in
+            request.notifyProgress(downloadProgress)
+        }, partialImage: partialImage, response: { response, bodyLength in
+            validators = ResourceValidators(response: response, contentLength: bodyLength)
+        }, data: originalData, deadline: request.deadline) { [weak self] image, error in
             guard let self = self else { return }
 
             // Handle error
             if let error = error {
-                self.notifyFailure(url: url, error: error, completion: completion)
+                // Bytes looked like an image but do not decode, do not keep them
+                // Queued after the write of the same URL, so it cannot overtake it
+                if storesOriginalData, case .decodingFailed? = error as? ImageDownloaderError {
+                    self.storageAgent.scheduleRemoveImage(for: url)
+                }
+                self.finish(request, image: nil, error: error, fromCache: false, fromStorage: false)
                 return
             }
 
@@ -123,69 +174,82 @@ extension ImageDownloaderManager {
                 let error = ImageDownloaderError.unknown(
                     NSError(domain: "ImageDownloader", code: -1, userInfo: nil)
                 )
-                self.notifyFailure(url: url, error: error, completion: completion)
+                self.finish(request, image: nil, error: error, fromCache: false, fromStorage: false)
                 return
             }
 
             // Process downloaded image: save to storage, update cache, notify
-            self.processDownloadedImage(image, url: url, latency: latency, completion: completion)
+            self.processDownloadedImage(
+                image,
+                request: request,
+                latency: latency,
+                validators: validators,
+                isStored: storesOriginalData
+            )
+        }
+        if !request.attachNetworkToken(token) {
+            networkAgent.cancelDownload(token)
         }
     }
 
-    /// Process downloaded image: save to storage, update cache, notify
-    private func processDownloadedImage(
-        _ image: UIImage,
-        url: URL,
-        latency: ResourceUpdateLatency,
-        completion: ImageCompletionBlock?
-    ) {
-        // Save to storage on background thread
-        DispatchQueue.global(qos: .userInitiated).async { [weak self] in
+    /// Ask the server whether a stored image changed, when its validators say it is stale
+    /// - 304: only the stored validators are refreshed, nothing is decoded or rewritten
+    /// - 200: the new image replaces the stored and cached one
+    private func revalidateIfNeeded(_ url: URL, latency: ResourceUpdateLatency) async {
+        guard configuration.revalidatesStoredImages,
+              let storedValidators = await storageAgent.loadValidators(for: url),
+              storedValidators.canRevalidate,
+              !storedValidators.isFresh() else {
+            return
+        }
+
+        var newValidators: ResourceValidators?
+        let storesOriginalData = configuration.shouldSaveToStorage && configuration.storesOriginalData
+        let originalData: DownloadDataHandler? = storesOriginalData
+            ? { [weak self] data in self?.storageAgent.scheduleSaveImageData(data, for: url, validators: newValidators) }
+            : nil
+
+        networkAgent.downloadData(at: url, priority: .low, validators: storedValidators, response: { response, bodyLength in
+            if bodyLength > 0 {
+                newValidators = ResourceValidators(response: response, contentLength: bodyLength)
+            }
+        }, data: originalData) { [weak self] image, error in
             guard let self = self else { return }
 
-            // Save to storage
-            if configuration.shouldSaveToStorage {
-                _ = self.storageAgent.saveImage(image, for: url)
+            if let notModified = error as? ResourceNotModified {
+                self.storageAgent.scheduleSaveValidators(storedValidators.refreshed(with: notModified.response), for: url)
+                return
+            }
+            guard let image = image else { return }
+
+            if self.configuration.shouldSaveToStorage, !storesOriginalData {
+                self.storageAgent.scheduleSaveImage(image, for: url, validators: newValidators)
             }
-            // Update cache and notify
             Task {
                 await self.cacheAgent.setImage(image, for: url, isHighLatency: latency.isHighLatency)
-                self.notifySuccess(url: url, image: image, completion: completion)
             }
         }
     }
 
-    /// Notify success on main thread
-    private func notifySuccess(url: URL, image: UIImage, completion: ImageCompletionBlock?) {
-        DispatchQueue.main.async {
-            // Notify original caller first
-            completion?(image, nil, false, false)
-
-            // Notify all waiting callers
-            self.notifyCallers(
-                url: url,
-                image: image,
-                error: nil,
-                fromCache: false,
-                fromStorage: false
-            )
-        }
-    }
+    /// Process downloaded image: save to storage, update cache, notify
+    /// - Parameter isStored: Original bytes were already written, nothing to re-encode
+    private func processDownloadedImage(
+        _ image: UIImage,
+        request: InFlightRequest,
+        latency: ResourceUpdateLatency,
+        validators: ResourceValidators?,
+        isStored: Bool = false
+    ) {
+        let url = request.url
 
-    /// Notify failure on main thread
-    private func notifyFailure(url: URL, error: Error, completion: ImageCompletionBlock?) {
-        DispatchQueue.main.async {
-            // Notify original caller first
-            completion?(nil, error, false, false)
-
-            // Notify all waiting callers
-            self.notifyCallers(
-                url: url,
-                image: nil,
-                error: error,
-                fromCache: false,
-                fromStorage: false
-            )
+        // Save to storage, re-encoded by the compression provider on the storage I/O executor
+        if configuration.shouldSaveToStorage, !isStored {
+            storageAgent.scheduleSaveImage(image, for: url, validators: validators)
+        }
+        // Update cache and notify
+        Task {
+            await self.cacheAgent.setImage(image, for: url, isHighLatency: latency.isHighLatency)
+            self.finish(request, image: image, error: nil, fromCache: false, fromStorage: false)
         }
     }
 }
@@ -50,10 +50,10 @@ public class ImageDownloaderManager: NSObject {
     private static var instances: [String: ImageDownloaderManager] = [:]
     private static let instancesLock = NSLock()
 
-    // MARK: - Caller Registry
-    /// Stores waiting callers and their completion blocks
-    /// Key: URL string, Value: Array of (weak caller, completion, progress)
-    private var callerRegistry: [String: [(caller: WeakBox<AnyObject>, completion: ImageCompletionBlock, progress: ImageProgressBlock?)]] = [:]
+    // MARK: - In-flight Requests
+    /// One shared operation per URL, every concurrent request for that URL subscribes to it
+    /// Key: URL string
+    private var inFlightRequests: [String: InFlightRequest] = [:]
     private let registryLock = NSLock()
     private var cleanupTimer: Timer?
 
@@ -125,76 +125,113 @@ extension ImageDownloaderManager {
         }
     }
     
-    /// Register a caller waiting for an image
+    /// Subscribe to the in-flight operation of a URL, creating it if needed
     /// - Parameters:
     ///   - url: The URL being requested
-    ///   - caller: The object making the request (stored weakly)
+    ///   - caller: The object making the request (stored weakly, nil = always notified)
+    ///   - priority: Download priority wanted by this caller
+    ///   - deadline: Latest date the download may wait for a slot, nil = default timeout
     ///   - completion: Completion block to call when image is ready
     ///   - progress: Optional progress block
-    func registerCaller(
+    ///   - partialImage: Optional block receiving intermediate frames
+    /// - Returns: The operation, and whether the caller created it (and so must run it)
+    func subscribe(
         url: URL,
         caller: AnyObject?,
-        completion: @escaping ImageCompletionBlock,
-        progress: ImageProgressBlock?
-    ) {
-        guard let caller = caller else { return }
-
+        priority: DownloadPriority,
+        deadline: Date? = nil,
+        completion: ImageCompletionBlock?,
+        progress: ImageProgressBlock?,
+        partialImage: ImagePartialBlock? = nil
+    ) -> (request: InFlightRequest, isNew: Bool) {
         let urlKey = url.absoluteString
 
         registryLock.lock()
         defer { registryLock.unlock() }
 
-        // Add to registry
-        let entry = (caller: WeakBox(caller), completion: completion, progress: progress)
-        callerRegistry[urlKey, default: []].append(entry)
+        if let existing = inFlightRequests[urlKey] {
+            existing.addSubscriber(caller: caller, completion: completion, progress: progress, partialImage: partialImage)
+            // Priority inheritance: a more urgent subscriber speeds up the shared download
+            if existing.raisePriority(to: priority) {
+                networkAgent.updatePriority(for: url, to: priority)
+            }
+            // A more patient subscriber keeps the shared download queued longer
+            if existing.extendDeadline(to: deadline) {
+                networkAgent.updateDeadline(for: url, to: existing.deadline)
+            }
+            return (existing, false)
+        }
+
+        let request = InFlightRequest(url: url, priority: priority, deadline: deadline)
+        request.addSubscriber(caller: caller, completion: completion, progress: progress, partialImage: partialImage)
+        inFlightRequests[urlKey] = request
+        return (request, true)
     }
 
-    /// Notify all waiting callers for a URL
+    /// Complete the in-flight operation of a URL and notify every subscriber
     /// - Parameters:
-    ///   - url: The URL that finished loading
+    ///   - request: The operation that finished
     ///   - image: The loaded image (nil if error)
     ///   - error: The error (nil if success)
     ///   - fromCache: Whether image came from cache
     ///   - fromStorage: Whether image came from storage
-    func notifyCallers(
-        url: URL,
+    func finish(
+        _ request: InFlightRequest,
         image: UIImage?,
         error: Error?,
         fromCache: Bool,
         fromStorage: Bool
     ) {
-        let urlKey = url.absoluteString
+        let urlKey = request.url.absoluteString
 
+        // Unregister first, later requests then start from the (already updated) cache
         registryLock.lock()
-        let waiters = callerRegistry[urlKey] ?? []
-        callerRegistry.removeValue(forKey: urlKey)
+        if inFlightRequests[urlKey] === request {
+            inFlightRequests.removeValue(forKey: urlKey)
+        }
         registryLock.unlock()
 
-        // Notify all waiters (only if caller still alive)
-        for waiter in waiters {
-            // Check if caller is still alive
-            if waiter.caller.value != nil {
-                // Call on main thread
-                DispatchQueue.main.async {
-                    waiter.completion(image, error, fromCache, fromStorage)
-                }
-            }
+        request.finish(image: image, error: error, fromCache: fromCache, fromStorage: fromStorage)
+    }
+
+    /// Stop an operation whose subscribers all cancelled
+    /// It is unregistered at once, so a later request for the URL starts a fresh operation
+    func abandon(_ request: InFlightRequest) {
+        let urlKey = request.url.absoluteString
+
+        // Under the registry lock: no subscriber can join between the check and the unregistration
+        registryLock.lock()
+        guard request.abandonIfUnused() else {
+            registryLock.unlock()
+            return
+        }
+        if inFlightRequests[urlKey] === request {
+            inFlightRequests.removeValue(forKey: urlKey)
+        }
+        registryLock.unlock()
+
+        // Nil while still reading cache or storage, the network stage then does not start
+        if let token = request.networkToken {
+            networkAgent.cancelDownload(token)
         }
     }
 
+    /// In-flight operation of a URL, nil when nothing is loading it
+    func inFlightRequest(for url: URL) -> InFlightRequest? {
+        registryLock.lock()
+        defer { registryLock.unlock() }
+        return inFlightRequests[url.absoluteString]
+    }
+
     /// Clean up dead callers periodically
     func cleanupDeadCallers() {
         registryLock.lock()
-        defer { registryLock.unlock() }
+        let requests = Array(inFlightRequests.values)
+        registryLock.unlock()
 
-        // Remove entries where caller is nil
-        for (urlKey, waiters) in callerRegistry {
-            let aliveWaiters = waiters.filter { $0.caller.value != nil }
-            if aliveWaiters.isEmpty {
-                callerRegistry.removeValue(forKey: urlKey)
-            } else {
-                callerRegistry[urlKey] = aliveWaiters
-            }
+        // Operations keep running even if every caller died, the result still fills cache/storage
+        for request in requests {
+            request.removeDeadSubscribers()
         }
     }
 }
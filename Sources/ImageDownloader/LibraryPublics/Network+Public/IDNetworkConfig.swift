@@ -16,10 +16,86 @@ import Foundation
     @objc public var timeout: TimeInterval
     @objc public var allowsCellularAccess: Bool
 
+    /// Slots a single host may use at once, so one slow host cannot stall the others
+    /// Queued downloads are served round-robin across hosts. Both limits apply: a download starts
+    /// only when the global window (`maxConcurrentDownloads`, or the adaptive window) and its host
+    /// have a free slot, so a value at or above the window never binds
+    /// (default: -1 = half of the window, at least 1; 0 = no per host limit)
+    @objc public var maxConcurrentDownloadsPerHost: Int = -1
+
+    /// Minimum seconds between two progress callbacks of a download (default: 0.1, 0 = every received chunk)
+    @objc public var progressInterval: TimeInterval = 0.1
+
+    /// Minimum seconds between two partial frames delivered to a `partialImage` block (default: 0.25)
+    /// Every frame is a full decode of the bytes received so far, keep it coarse
+    @objc public var progressiveDecodingInterval: TimeInterval = 0.25
+
+    /// Bytes of interrupted downloads kept in memory to resume them with range requests
+    /// when the server sends `Accept-Ranges: bytes` (default: 20MB, 0 = never resume)
+    @objc public var partialDownloadsMemoryLimit: Int = 20 * 1024 * 1024
+
+    // MARK: - Scheduling Settings
+
+    /// Seconds a queued download has to wait to be served like one priority level higher (default: 5)
+    /// Prevents low priority downloads from starving behind a stream of high priority ones
+    @objc public var priorityAgingInterval: TimeInterval = 5
+
+    /// Seconds a download may wait for a slot before failing with `.timeout`, unless the request
+    /// gave its own deadline (default: 60). Expired downloads fail when their deadline passes
+    @objc public var pendingRequestTimeout: TimeInterval = 60
+
+    /// Downloads waiting for a slot at most, see `pendingOverflowPolicy` (default: 0 = unbounded)
+    @objc public var maxPendingDownloads: Int = 0
+
+    /// What to drop when `maxPendingDownloads` downloads are already waiting (default: dropOldestLowPriority)
+    @objc public var pendingOverflowPolicy: IDQueueOverflowPolicy = .dropOldestLowPriority
+
+    /// Adjust the concurrency window from observed latency instead of using a fixed
+    /// `maxConcurrentDownloads` (which becomes the starting window) (default: false)
+    @objc public var adaptiveConcurrency: Bool = false
+
+    /// Lower bound of the adaptive concurrency window (default: 1)
+    @objc public var minAdaptiveConcurrentDownloads: Int = 1
+
+    /// Upper bound of the adaptive concurrency window (default: 16)
+    @objc public var maxAdaptiveConcurrentDownloads: Int = 16
+
+    /// When the last caller of a download cancels it, lower it to `.low` and let it finish into
+    /// cache and storage instead of cancelling it (default: false)
+    /// Useful when cells scrolled away are likely to come back
+    /// Applied by `cancelRequest(for:caller:)` of the manager, not by the network agent
+    @objc public var deprioritizesCancelledDownloads: Bool = false
+
+    /// Send a second identical request when a download has no first byte after the
+    /// `hedgePercentile` of recent time-to-first-byte, the first to finish wins (default: false)
+    @objc public var hedgingEnabled: Bool = false
+
+    /// Time-to-first-byte percentile waited before hedging (default: 0.95)
+    @objc public var hedgePercentile: Double = 0.95
+
+    /// Hedges allowed per download (default: 0.05 = at most 5% extra requests)
+    @objc public var hedgeBudgetRatio: Double = 0.05
+
     // MARK: - Retry Settings
 
     @objc public var retryPolicy: IDRetryPolicy
 
+    /// Retries allowed per download, across all hosts (default: 0.1 = at most 10% extra requests)
+    /// A small saved up budget absorbs short bursts, a failing host cannot multiply the request rate
+    @objc public var retryBudgetRatio: Double = 0.1
+
+    // MARK: - Failure Protection
+
+    /// Consecutive failures (timeouts, connection errors, 5xx) of a host before its requests
+    /// fail fast for `circuitBreakerOpenInterval` (default: 5, 0 = disabled)
+    @objc public var circuitBreakerFailureThreshold: Int = 5
+
+    /// Seconds requests to a failing host fail fast before one probe request is let through (default: 30)
+    @objc public var circuitBreakerOpenInterval: TimeInterval = 30
+
+    /// Seconds a 404, or a URL whose data failed to decode twice, fails without downloading (default: 300, 0 = disabled)
+    @objc public var negativeCacheTTL: TimeInterval = 300
+
     // MARK: - Authentication & Headers
 
     @objc public var customHeaders: [String: String]?
@@ -55,11 +131,29 @@ import Foundation
     func toInternalConfig() -> NetworkConfig {
         return NetworkConfig(
             maxConcurrentDownloads: maxConcurrentDownloads,
+            maxConcurrentDownloadsPerHost: maxConcurrentDownloadsPerHost,
             timeout: timeout,
             allowsCellularAccess: allowsCellularAccess,
             retryPolicy: retryPolicy.toSwift(),
             customHeaders: customHeaders,
-            authenticationHandler: authenticationHandler
+            authenticationHandler: authenticationHandler,
+            priorityAgingInterval: priorityAgingInterval,
+            pendingRequestTimeout: pendingRequestTimeout,
+            maxPendingDownloads: maxPendingDownloads,
+            pendingOverflowPolicy: pendingOverflowPolicy,
+            progressInterval: progressInterval,
+            progressiveDecodingInterval: progressiveDecodingInterval,
+            partialDownloadsMemoryLimit: partialDownloadsMemoryLimit,
+            retryBudgetRatio: retryBudgetRatio,
+            circuitBreakerFailureThreshold: circuitBreakerFailureThreshold,
+            circuitBreakerOpenInterval: circuitBreakerOpenInterval,
+            negativeCacheTTL: negativeCacheTTL,
+            adaptiveConcurrency: adaptiveConcurrency,
+            minAdaptiveConcurrentDownloads: minAdaptiveConcurrentDownloads,
+            maxAdaptiveConcurrentDownloads: maxAdaptiveConcurrentDownloads,
+            hedgingEnabled: hedgingEnabled,
+            hedgePercentile: hedgePercentile,
+            hedgeBudgetRatio: hedgeBudgetRatio
         )
     }
 }
@@ -0,0 +1,17 @@
+//
+//  IDQueueOverflowPolicy.swift
+//  ImageDownloader
+//
+//  Objective-C compatible policy for a full download queue
+//
+
+import Foundation
+
+/// What happens to a download that has to wait while the pending queue is full
+@objc public enum IDQueueOverflowPolicy: Int {
+    /// Drop the oldest queued download of the lowest priority to make room,
+    /// the new download is rejected if it has an even lower priority (default)
+    case dropOldestLowPriority
+    /// Reject the new download, queued ones keep their place
+    case rejectNew
+}
@@ -10,6 +10,12 @@ import Foundation
 /// Policy for retrying failed network requests
 public struct RetryPolicy {
 
+    /// `userInfo` key of the `HTTPURLResponse` in errors built from a non-2xx answer
+    public static let httpResponseUserInfoKey = "ImageDownloaderHTTPResponse"
+
+    /// HTTP statuses worth another attempt: timeouts, rate limiting and transient server errors
+    public static let retryableStatusCodes: Set<Int> = [408, 429, 500, 502, 503, 504]
+
     // MARK: - Properties
 
     /// Maximum number of retry attempts
@@ -84,6 +90,54 @@ public struct RetryPolicy {
         return min(calculatedDelay, maxDelay)
     }
 
+    /// Decorrelated jitter backoff: random in `baseDelay...previousDelay * 3`, capped at `maxDelay`
+    /// Spreads retries of requests that failed together instead of retrying them in lockstep
+    /// - Parameter previousDelay: Delay used before the previous retry (0 for the first retry,
+    ///   which is seeded with `baseDelay` so it is already drawn from `baseDelay...baseDelay * 3`)
+    /// - Returns: The delay in seconds before the next retry
+    public func jitteredDelay(previousDelay: TimeInterval) -> TimeInterval {
+        guard baseDelay > 0 else { return 0 }
+        let upperBound = max(baseDelay, previousDelay) * 3
+        return min(maxDelay, TimeInterval.random(in: baseDelay...upperBound))
+    }
+
+    /// Determine if a retry should be attempted for an HTTP status
+    /// - Parameters:
+    ///   - statusCode: Status of the response
+    ///   - attempt: The current attempt number (0 = first attempt, 1 = first retry, etc.)
+    ///   - url: Optional URL for logging context
+    public func shouldRetry(statusCode: Int, attempt: Int, url: URL? = nil) -> Bool {
+        guard attempt < maxRetries, Self.retryableStatusCodes.contains(statusCode) else {
+            return false
+        }
+        if enableLogging {
+            print("[ImageDownloader] 🔄 Retry \(attempt + 1)/\(maxRetries) for \(url?.absoluteString ?? "unknown") - HTTP \(statusCode)")
+        }
+        return true
+    }
+
+    /// Seconds asked by a `Retry-After` header (delay-seconds or HTTP date), nil when absent
+    public static func retryAfter(from response: HTTPURLResponse, now: Date = Date()) -> TimeInterval? {
+        guard let value = response.value(forHTTPHeaderField: "Retry-After")?.trimmingCharacters(in: .whitespaces) else {
+            return nil
+        }
+        if let seconds = TimeInterval(value) {
+            return max(seconds, 0)
+        }
+        if let date = retryAfterDateFormatter.date(from: value) {
+            return max(date.timeIntervalSince(now), 0)
+        }
+        return nil
+    }
+
+    private static let retryAfterDateFormatter: DateFormatter = {
+        let formatter = DateFormatter()
+        formatter.locale = Locale(identifier: "en_US_POSIX")
+        formatter.timeZone = TimeZone(identifier: "GMT")
+        formatter.dateFormat = "EEE, dd MMM yyyy HH:mm:ss zzz"
+        return formatter
+    }()
+
     /// Determine if a retry should be attempted for the given error
     /// - Parameters:
     ///   - error: The error that occurred
@@ -150,11 +204,8 @@ public struct RetryPolicy {
         }
 
         // Check for HTTP status codes (if available)
-        if let httpResponse = (error as NSError).userInfo[NSURLErrorFailingURLStringErrorKey] as? HTTPURLResponse {
-            // Retry server errors (5xx) and rate limiting (429)
-            if httpResponse.statusCode >= 500 || httpResponse.statusCode == 429 {
-                return true
-            }
+        if let httpResponse = nsError.userInfo[Self.httpResponseUserInfoKey] as? HTTPURLResponse {
+            return Self.retryableStatusCodes.contains(httpResponse.statusCode)
         }
 
         // Default to not retrying unknown errors
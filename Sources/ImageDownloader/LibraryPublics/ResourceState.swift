@@ -5,6 +5,8 @@
 //  Model representing a downloadable image resource
 //
 
+import Foundation
+
 @objc public enum ResourceState: Int {
     case unknown
     case downloading
@@ -22,8 +24,42 @@
 }
 
 
+/// Download scheduling priority, served in `rank` order
+/// Waiting requests age toward higher priority, so low priority work is never starved
+/// Raw values are ABI: existing cases keep theirs, new cases get the next free value
 @objc public enum DownloadPriority: Int {
     case high = 1
-//    case `default` = 2
     case low = 2
+    case normal = 3
+}
+
+extension DownloadPriority {
+    /// Scheduling level, smaller is served first (one aging step per level)
+    var rank: Int {
+        switch self {
+        case .high:
+            return 1
+        case .normal:
+            return 2
+        case .low:
+            return 3
+        }
+    }
+
+    /// Whether this priority is served before `other`
+    func isHigher(than other: DownloadPriority) -> Bool {
+        rank < other.rank
+    }
+
+    /// Matching `URLSessionTask.priority` value
+    var urlSessionTaskPriority: Float {
+        switch self {
+        case .high:
+            return URLSessionTask.highPriority
+        case .normal:
+            return URLSessionTask.defaultPriority
+        case .low:
+            return URLSessionTask.lowPriority
+        }
+    }
 }
@@ -15,6 +15,35 @@ import Foundation
     @objc public var shouldSaveToStorage: Bool
     @objc public var storagePath: String?
 
+    /// Revalidate stale stored images with the server (default: true)
+    /// The stored image is served right away, then a conditional request (If-None-Match /
+    /// If-Modified-Since) refreshes it; a 304 answer only refreshes the stored validators
+    @objc public var revalidatesStoredImages: Bool = true
+
+    /// Write downloaded bytes to disk exactly as received, in parallel with decoding (default: true)
+    /// Set false to re-encode every downloaded image through `compressionProvider`
+    /// (images without original bytes, e.g. inserted from memory cache, always use the provider)
+    @objc public var storesOriginalData: Bool = true
+
+    /// Disk budget in bytes of stored images (default: 0 = unlimited)
+    /// When exceeded, images are removed in the background until 90% of the budget is left
+    @objc public var maxStorageSize: Int = 0
+
+    /// Disk budget in number of stored images (default: 0 = unlimited)
+    @objc public var maxFileCount: Int = 0
+
+    /// Which images are removed first when over budget (default: lru)
+    @objc public var evictionPolicy: IDStorageEvictionPolicy = .lru
+
+    /// Images up to this size in bytes are appended to shared pack files instead of one file each
+    /// (default: 0 = one file per image). Around 20KB suits thumbnails and avatars: no per-file
+    /// block and inode overhead, and reads are memory-mapped without an open/close per image
+    @objc public var packedImageMaxSize: Int = 0
+
+    /// Disk reads and writes running at the same time (default: 4)
+    /// Storage I/O runs on its own queue, reads are served before pending writes
+    @objc public var maxConcurrentIO: Int = 4
+
     // MARK: - Customization Providers (Objective-C wrappers)
     @objc public var identifierProvider: ResourceIdentifierProvider
     @objc public var pathProvider: StoragePathProvider
@@ -56,7 +85,14 @@ import Foundation
             storagePath: storagePath,
             identifierProvider: identifierProvider,
             pathProvider: pathProvider,
-            compressionProvider: compressionProvider
+            compressionProvider: compressionProvider,
+            revalidatesStoredImages: revalidatesStoredImages,
+            storesOriginalData: storesOriginalData,
+            maxStorageSize: maxStorageSize,
+            maxFileCount: maxFileCount,
+            evictionPolicy: evictionPolicy,
+            packedImageMaxSize: packedImageMaxSize,
+            maxConcurrentIO: maxConcurrentIO
         )
     }
 }
@@ -0,0 +1,16 @@
+//
+//  IDStorageEvictionPolicy.swift
+//  ImageDownloader
+//
+//  Objective-C compatible disk eviction policy selection
+//
+
+import Foundation
+
+/// Which stored images are removed first when the disk budget is exceeded
+@objc public enum IDStorageEvictionPolicy: Int {
+    /// Least recently read first (default)
+    case lru
+    /// Least often read first, least recently read among equals
+    case lfu
+}
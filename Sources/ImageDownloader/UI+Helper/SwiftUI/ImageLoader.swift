@@ -24,21 +24,45 @@ public class ImageLoader: ObservableObject {
 
     public init() {}
 
+    /// Load an image, publishing progress and (when `progressive`) intermediate frames into `image`
     @MainActor
     public func load(
         from url: URL,
         config: IDConfiguration? = nil,
-        priority: DownloadPriority = .low
+        priority: DownloadPriority = .low,
+        progressive: Bool = false
     ) {
         self.url = url
         self.config = config
+        self.image = nil
         self.isLoading = true
         self.progress = 0.0
         self.error = nil
 
         // Use completion-based API for progress tracking
         let manager = ImageDownloaderManager.instance(for: config)
-        
+        manager.requestImage(
+            at: url,
+            caller: self,
+            downloadPriority: priority,
+            progress: { [weak self] prog, _, _ in
+                guard let self = self, self.url == url else { return }
+                self.progress = prog
+            },
+            partialImage: progressive ? { [weak self] frame in
+                guard let self = self, self.url == url, self.isLoading else { return }
+                self.image = frame
+            } : nil,
+            completion: { [weak self] image, error, _, _ in
+                guard let self = self, self.url == url else { return }
+                self.isLoading = false
+                self.error = error
+                if let image = image {
+                    self.image = image
+                    self.progress = 1.0
+                }
+            }
+        )
     }
 
     public func cancel() {
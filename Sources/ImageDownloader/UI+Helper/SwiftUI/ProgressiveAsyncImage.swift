@@ -12,6 +12,7 @@ import SwiftUI
 /// - Automatic cancellation on disappear
 /// - URL change detection with automatic cancel/reload
 /// - Progress tracking
+/// - Progressive rendering: intermediate frames are shown while the image downloads
 @available(iOS 15.0, macOS 10.15, *)
 public struct ProgressiveAsyncImage<Content: View, Placeholder: View>: View {
 
@@ -50,10 +51,10 @@ public struct ProgressiveAsyncImage<Content: View, Placeholder: View>: View {
             }
         }
         .onAppear {
-            loader.load(from: url, config: config, priority: priority)
+            loader.load(from: url, config: config, priority: priority, progressive: true)
         }
         .onChange(of: url) { newURL in
-            loader.load(from: newURL, config: config, priority: priority)
+            loader.load(from: newURL, config: config, priority: priority, progressive: true)
         }
         .onDisappear {
             loader.cancel()
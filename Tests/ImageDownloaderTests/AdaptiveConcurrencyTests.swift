@@ -0,0 +1,126 @@
+//
+//  AdaptiveConcurrencyTests.swift
+//  ImageDownloaderTests
+//
+//  Adaptive concurrency window against a stubbed server with injected queueing latency,
+//  and against a saturated link
+//
+
+import XCTest
+@testable import ImageDownloader
+
+final class AdaptiveConcurrencyTests: XCTestCase {
+    private let initialLimit = 4
+    private let maxLimit = 16
+    private let downloadsPerPhase = 100
+    /// Latency of a request the server answers without queueing
+    private let baseLatency: TimeInterval = 0.01
+
+    private let lock = NSLock()
+    private var isCongested = false
+    private var agent: NetworkAgent!
+
+    override func setUp() {
+        super.setUp()
+        let body = TestImages.pngData()
+        StubURLProtocol.install { [unowned self] _ in
+            // A congested server serves one request at a time: latency grows with the requests in flight
+            let latency = self.congested ? self.baseLatency * Double(StubURLProtocol.inFlightCount) : self.baseLatency
+            return StubURLProtocol.Reply(headers: ["Content-Type": "image/png"], body: body, delay: latency)
+        }
+        agent = NetworkAgent(config: NetworkConfig(
+            maxConcurrentDownloads: initialLimit,
+            maxConcurrentDownloadsPerHost: 0,
+            retryPolicy: .none,
+            partialDownloadsMemoryLimit: 0,
+            circuitBreakerFailureThreshold: 0,
+            negativeCacheTTL: 0,
+            adaptiveConcurrency: true,
+            minAdaptiveConcurrentDownloads: 2,
+            maxAdaptiveConcurrentDownloads: maxLimit
+        ))
+    }
+
+    override func tearDown() {
+        agent = nil
+        StubURLProtocol.uninstall()
+        super.tearDown()
+    }
+
+    /// Fast server: the window opens up to the maximum
+    /// Queueing server: latency rises above the baseline and the window closes
+    /// Fast again: the window opens back up
+    func testWindowShrinksUnderQueueingLatencyAndRecovers() {
+        let opened = runPhase("open")
+        XCTAssertGreaterThan(opened.last!, initialLimit)
+
+        congested = true
+        let throttled = runPhase("congested")
+        XCTAssertLessThan(throttled.min()!, opened.last!)
+        XCTAssertGreaterThanOrEqual(throttled.min()!, 2)
+
+        congested = false
+        let recovered = runPhase("recovered")
+        XCTAssertGreaterThan(recovered.last!, throttled.min()!)
+        XCTAssertLessThanOrEqual(recovered.max()!, maxLimit)
+    }
+
+    /// Same latency in both runs: the window keeps growing only while more downloads in flight
+    /// bring more bytes per second, and stops when the link is saturated
+    func testWindowStopsGrowingWhenThroughputPlateaus() {
+        let scaling = AdaptiveConcurrencyLimiter(initialLimit: initialLimit, minLimit: 1, maxLimit: 32)
+        let saturated = AdaptiveConcurrencyLimiter(initialLimit: initialLimit, minLimit: 1, maxLimit: 32)
+
+        for _ in 0..<300 {
+            // 100 KB/s per download, however many run
+            scaling.recordSuccess(latency: 0.1, bytes: 10_000, duration: 0.1, inFlight: scaling.currentLimit)
+            // 400 KB/s shared by every download in flight
+            let inFlight = saturated.currentLimit
+            saturated.recordSuccess(latency: 0.1, bytes: Int64(40_000 / inFlight), duration: 0.1, inFlight: inFlight)
+        }
+
+        XCTAssertEqual(scaling.currentLimit, 32)
+        XCTAssertLessThan(saturated.currentLimit, 16)
+    }
+
+    // MARK: - Helpers
+
+    private var congested: Bool {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return isCongested
+        }
+        set {
+            lock.lock()
+            isCongested = newValue
+            lock.unlock()
+        }
+    }
+
+    /// Download `downloadsPerPhase` distinct URLs at once
+    /// - Returns: The window after each completed download, in completion order
+    private func runPhase(_ name: String) -> [Int] {
+        let finished = expectation(description: "\(name) downloads finished")
+        finished.expectedFulfillmentCount = downloadsPerPhase
+        let samplesLock = NSLock()
+        var samples: [Int] = []
+
+        for index in 0..<downloadsPerPhase {
+            let url = URL(string: "https://stub.example.com/\(name)/\(index).png")!
+            _ = agent.downloadData(at: url) { [agent] _, error in
+                XCTAssertNil(error)
+                let limit = agent!.currentConcurrencyLimit
+                samplesLock.lock()
+                samples.append(limit)
+                samplesLock.unlock()
+                finished.fulfill()
+            }
+        }
+        wait(for: [finished], timeout: 30)
+
+        samplesLock.lock()
+        defer { samplesLock.unlock() }
+        return samples
+    }
+}
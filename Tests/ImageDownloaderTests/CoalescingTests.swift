@@ -0,0 +1,118 @@
+//
+//  CoalescingTests.swift
+//  ImageDownloaderTests
+//
+//  Concurrent requests for one URL share one operation, one download and one decode
+//
+
+import XCTest
+import UIKit
+@testable import ImageDownloader
+
+final class CoalescingTests: XCTestCase {
+    private let url = URL(string: "https://example.com/shared.png")!
+    private let requestCount = 100
+    private var storageDirectory: URL!
+
+    override func setUp() {
+        super.setUp()
+        storageDirectory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: storageDirectory)
+        super.tearDown()
+    }
+
+    /// 100 concurrent subscribers: one creates the operation, the others join it,
+    /// and every one of them gets the same image instance
+    func testConcurrentRequestsShareOneOperation() {
+        let storage = IDStorageConfig(shouldSaveToStorage: false, storagePath: storageDirectory.path)
+        let manager = ImageDownloaderManager(config: IDConfiguration(storage: storage))
+
+        let lock = NSLock()
+        var created: [InFlightRequest] = []
+        var joinedCount = 0
+        // Completions run on the main thread
+        var delivered: [UIImage] = []
+        let completed = expectation(description: "every subscriber completed")
+        completed.expectedFulfillmentCount = requestCount
+
+        DispatchQueue.concurrentPerform(iterations: requestCount) { _ in
+            let (request, isNew) = manager.subscribe(
+                url: url,
+                caller: nil,
+                priority: .high,
+                completion: { image, error, _, _ in
+                    XCTAssertNil(error)
+                    if let image = image {
+                        delivered.append(image)
+                    }
+                    completed.fulfill()
+                },
+                progress: nil
+            )
+            lock.lock()
+            if isNew {
+                created.append(request)
+            } else {
+                joinedCount += 1
+            }
+            lock.unlock()
+        }
+
+        XCTAssertEqual(created.count, 1)
+        XCTAssertEqual(joinedCount, requestCount - 1)
+        XCTAssertTrue(manager.inFlightRequest(for: url) === created.first)
+
+        let image = TestImages.image()
+        manager.finish(created[0], image: image, error: nil, fromCache: false, fromStorage: false)
+        wait(for: [completed], timeout: 5)
+
+        XCTAssertEqual(delivered.count, requestCount)
+        XCTAssertTrue(delivered.allSatisfy { $0 === image })
+        XCTAssertNil(manager.inFlightRequest(for: url))
+    }
+
+    /// 100 concurrent downloads of one URL through the network agent: one request goes out,
+    /// the decoder runs once and every caller gets the same image
+    func testConcurrentDownloadsDecodeOnce() {
+        let body = TestImages.pngData(width: 8, height: 8)
+        StubURLProtocol.install { _ in
+            // Slow enough for every caller to join before the body arrives
+            StubURLProtocol.Reply(headers: ["Content-Type": "image/png"], body: body, delay: 0.2)
+        }
+        defer { StubURLProtocol.uninstall() }
+
+        let lock = NSLock()
+        var decodeCount = 0
+        var delivered: [UIImage] = []
+        let decodeQueue = DecodeQueue { data in
+            lock.lock()
+            decodeCount += 1
+            lock.unlock()
+            return ImageDecoder.decodeImage(from: data)
+        }
+        let agent = NetworkAgent(config: NetworkConfig(), decodeQueue: decodeQueue)
+        let completed = expectation(description: "every download completed")
+        completed.expectedFulfillmentCount = requestCount
+
+        DispatchQueue.concurrentPerform(iterations: requestCount) { _ in
+            _ = agent.downloadData(at: url) { image, error in
+                XCTAssertNil(error)
+                lock.lock()
+                if let image = image {
+                    delivered.append(image)
+                }
+                lock.unlock()
+                completed.fulfill()
+            }
+        }
+        wait(for: [completed], timeout: 10)
+
+        XCTAssertEqual(StubURLProtocol.requests.count, 1)
+        XCTAssertEqual(decodeCount, 1)
+        XCTAssertEqual(delivered.count, requestCount)
+        XCTAssertTrue(delivered.allSatisfy { $0 === delivered.first })
+    }
+}
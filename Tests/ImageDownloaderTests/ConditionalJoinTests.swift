@@ -0,0 +1,58 @@
+//
+//  ConditionalJoinTests.swift
+//  ImageDownloaderTests
+//
+//  Callers without a stored copy never join a conditional download
+//
+
+import XCTest
+@testable import ImageDownloader
+
+final class ConditionalJoinTests: XCTestCase {
+    private let url = URL(string: "https://stub.example.com/revalidated.png")!
+    private let etag = "\"v1\""
+    private var agent: NetworkAgent!
+
+    override func setUp() {
+        super.setUp()
+        let body = TestImages.pngData()
+        StubURLProtocol.install { [etag] request in
+            if request.value(forHTTPHeaderField: "If-None-Match") == etag {
+                return StubURLProtocol.Reply(statusCode: 304, headers: ["ETag": etag], delay: 0.2)
+            }
+            return StubURLProtocol.Reply(headers: ["Content-Type": "image/png", "ETag": etag], body: body)
+        }
+        agent = NetworkAgent(config: NetworkConfig(retryPolicy: .none))
+    }
+
+    override func tearDown() {
+        agent = nil
+        StubURLProtocol.uninstall()
+        super.tearDown()
+    }
+
+    /// A 304 has no body for an unconditional caller: it waits and downloads the image itself
+    func testUnconditionalCallerDoesNotJoinRevalidation() {
+        let response = HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: ["ETag": etag])!
+        let validators = ResourceValidators(response: response, contentLength: 100)!
+
+        let revalidated = expectation(description: "revalidation answered 304")
+        _ = agent.downloadData(at: url, validators: validators) { image, error in
+            XCTAssertNil(image)
+            XCTAssertTrue(error is ResourceNotModified)
+            revalidated.fulfill()
+        }
+        let downloaded = expectation(description: "unconditional caller got the image")
+        _ = agent.downloadData(at: url) { image, error in
+            XCTAssertNotNil(image)
+            XCTAssertNil(error)
+            downloaded.fulfill()
+        }
+        wait(for: [revalidated, downloaded], timeout: 10)
+
+        let requests = StubURLProtocol.requests
+        XCTAssertEqual(requests.count, 2)
+        XCTAssertEqual(requests.first?.value(forHTTPHeaderField: "If-None-Match"), etag)
+        XCTAssertNil(requests.last?.value(forHTTPHeaderField: "If-None-Match"))
+    }
+}
@@ -0,0 +1,78 @@
+//
+//  LRUListTests.swift
+//  ImageDownloaderTests
+//
+//  Hit latency of the intrusive LRU list from 100 to 100k entries
+//
+
+import XCTest
+import UIKit
+@testable import ImageDownloader
+
+final class LRUListTests: XCTestCase {
+    /// Promotions per measured run, the same at every list size
+    private let hitCount = 100_000
+
+    private static let image: UIImage = {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        return UIGraphicsImageRenderer(size: CGSize(width: 1, height: 1), format: format).image { _ in }
+    }()
+
+    func testMoveToTailKeepsRecencyOrder() {
+        let list = LRUList()
+        let entries = makeEntries(3)
+        entries.forEach(list.append)
+
+        list.moveToTail(entries[0])
+
+        XCTAssertTrue(list.head === entries[1])
+        XCTAssertTrue(list.tail === entries[0])
+        XCTAssertEqual(list.count, 3)
+        XCTAssertTrue(list.popHead() === entries[1])
+    }
+
+    // MARK: - Benchmarks
+    // O(1) promotion: the time per run should stay flat from 100 to 100k entries
+
+    func testHitLatency100Entries() {
+        measureHits(entryCount: 100)
+    }
+
+    func testHitLatency1kEntries() {
+        measureHits(entryCount: 1_000)
+    }
+
+    func testHitLatency10kEntries() {
+        measureHits(entryCount: 10_000)
+    }
+
+    func testHitLatency100kEntries() {
+        measureHits(entryCount: 100_000)
+    }
+
+    // MARK: - Helpers
+
+    private func makeEntries(_ count: Int) -> [CacheEntry] {
+        (0..<count).map { index in
+            CacheEntry(image: Self.image, url: URL(string: "https://example.com/\(index).png"))
+        }
+    }
+
+    /// Promote `hitCount` random entries of a list holding `entryCount` entries
+    private func measureHits(entryCount: Int) {
+        let list = LRUList()
+        let entries = makeEntries(entryCount)
+        entries.forEach(list.append)
+
+        let hits = (0..<hitCount).map { _ in Int.random(in: 0..<entryCount) }
+
+        measure {
+            for index in hits {
+                list.moveToTail(entries[index])
+            }
+        }
+        XCTAssertEqual(list.count, entryCount)
+        list.removeAll()
+    }
+}
@@ -0,0 +1,39 @@
+//
+//  NegativeCacheTests.swift
+//  ImageDownloaderTests
+//
+//  Expiry and capacity of the negative cache
+//
+
+import XCTest
+@testable import ImageDownloader
+
+final class NegativeCacheTests: XCTestCase {
+    private let ttl: TimeInterval = 60
+
+    /// A URL remembered again after expiring is the newest entry, not the oldest
+    func testReinsertedAfterExpiryIsNotEvictedFirst() {
+        let cache = NegativeCache(ttl: ttl, capacity: 2)
+        cache.recordNotFound("a")
+        XCTAssertNil(cache.error(for: "a", now: Date().addingTimeInterval(ttl + 1)))
+
+        cache.recordNotFound("b")
+        cache.recordNotFound("a")
+        cache.recordNotFound("c")
+
+        XCTAssertEqual(cache.count, 2)
+        XCTAssertNil(cache.error(for: "b"))
+        XCTAssertNotNil(cache.error(for: "a"))
+        XCTAssertNotNil(cache.error(for: "c"))
+    }
+
+    func testRemoveAllForgetsEveryURL() {
+        let cache = NegativeCache(ttl: ttl)
+        (0..<10).forEach { cache.recordNotFound("url-\($0)") }
+
+        cache.removeAll()
+
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertNil(cache.error(for: "url-0"))
+    }
+}
@@ -0,0 +1,117 @@
+//
+//  PendingQueueTests.swift
+//  ImageDownloaderTests
+//
+//  Priority order of the pending download queue, and its cost at 10k queued requests
+//
+
+import XCTest
+@testable import ImageDownloader
+
+final class PendingQueueTests: XCTestCase {
+    private let requestCount = 10_000
+    private let hostCount = 16
+    private let priorities: [DownloadPriority] = [.high, .normal, .low]
+
+    /// Raw values are part of the Objective-C ABI, `.normal` was added after `.low`
+    func testPriorityRawValuesAreStable() {
+        XCTAssertEqual(DownloadPriority.high.rawValue, 1)
+        XCTAssertEqual(DownloadPriority.low.rawValue, 2)
+        XCTAssertEqual(DownloadPriority.normal.rawValue, 3)
+    }
+
+    func testDequeuesByRankNotRawValue() {
+        let queue = PendingQueue(agingInterval: 5)
+        for priority in [DownloadPriority.low, .normal, .high] {
+            queue.enqueue(makeRequest(index: priority.rawValue, priority: priority))
+        }
+
+        XCTAssertEqual(queue.dequeue()?.priority, .high)
+        XCTAssertEqual(queue.dequeue()?.priority, .normal)
+        XCTAssertEqual(queue.dequeue()?.priority, .low)
+        XCTAssertTrue(queue.isEmpty)
+    }
+
+    /// Aging off: a later `.high` still goes before every earlier `.low` of the same host
+    func testWithoutAgingServesByPriorityThenFIFO() {
+        let queue = PendingQueue(agingInterval: 0)
+        let priorities: [DownloadPriority] = [.low, .low, .high, .normal]
+        for (index, priority) in priorities.enumerated() {
+            queue.enqueue(makeRequest(index: index, priority: priority))
+        }
+
+        let served = (0..<priorities.count).compactMap { _ in queue.dequeue() }
+        XCTAssertEqual(served.map { $0.priority }, [.high, .normal, .low, .low])
+        XCTAssertEqual(served.map { $0.url.lastPathComponent }, ["2.png", "3.png", "0.png", "1.png"])
+    }
+
+    // MARK: - Benchmarks
+    // O(log n + hosts) per operation: each run handles 10k requests spread over 16 hosts
+
+    func testEnqueuePerformance() {
+        measureMetrics([.wallClockTime], automaticallyStartMeasuring: false) {
+            let queue = PendingQueue(agingInterval: 5)
+            let requests = makeRequests()
+
+            startMeasuring()
+            for request in requests {
+                queue.enqueue(request)
+            }
+            stopMeasuring()
+
+            XCTAssertEqual(queue.count, requestCount)
+        }
+    }
+
+    func testReprioritizePerformance() {
+        measureMetrics([.wallClockTime], automaticallyStartMeasuring: false) {
+            let queue = PendingQueue(agingInterval: 5)
+            let requests = makeRequests()
+            requests.forEach(queue.enqueue)
+
+            startMeasuring()
+            for (index, request) in requests.enumerated() {
+                queue.updatePriority(for: request.url.absoluteString, to: priorities[(index + 1) % priorities.count])
+            }
+            stopMeasuring()
+
+            XCTAssertEqual(queue.count, requestCount)
+        }
+    }
+
+    func testDequeuePerformance() {
+        measureMetrics([.wallClockTime], automaticallyStartMeasuring: false) {
+            let queue = PendingQueue(agingInterval: 5)
+            makeRequests().forEach(queue.enqueue)
+
+            startMeasuring()
+            var dequeued = 0
+            while queue.dequeue() != nil {
+                dequeued += 1
+            }
+            stopMeasuring()
+
+            XCTAssertEqual(dequeued, requestCount)
+        }
+    }
+
+    // MARK: - Helpers
+
+    private func makeRequests() -> [PendingDownloadRequest] {
+        (0..<requestCount).map { index in
+            makeRequest(index: index, priority: priorities[index % priorities.count], host: "host\(index % hostCount).example.com")
+        }
+    }
+
+    private func makeRequest(index: Int, priority: DownloadPriority, host: String = "example.com") -> PendingDownloadRequest {
+        let url = URL(string: "https://\(host)/\(index).png")!
+        return PendingDownloadRequest(
+            url: url,
+            token: DownloadToken(url: url),
+            priority: priority,
+            progress: nil,
+            completion: { _, _ in },
+            deadline: Date(timeIntervalSinceNow: 3600)
+        )
+    }
+}
@@ -0,0 +1,143 @@
+//
+//  RangeResumeTests.swift
+//  ImageDownloaderTests
+//
+//  Interrupted downloads resume with Range / If-Range, and restart when the server ignores the range
+//
+
+import XCTest
+@testable import ImageDownloader
+
+final class RangeResumeTests: XCTestCase {
+    private let url = URL(string: "https://stub.example.com/large.png")!
+    private let etag = "\"v1\""
+    /// Bytes sent before the connection drops, above `PartialDownloadStore.minimumResumableBytes`
+    private let droppedAt = 100_000
+    private var body: Data!
+    private var agent: NetworkAgent!
+
+    override func setUp() {
+        super.setUp()
+        body = Data((0..<250_000).map { UInt8(truncatingIfNeeded: $0 &* 31) })
+        agent = NetworkAgent(config: NetworkConfig(
+            retryPolicy: RetryPolicy(maxRetries: 1, baseDelay: 0.01),
+            circuitBreakerFailureThreshold: 0,
+            negativeCacheTTL: 0
+        ))
+    }
+
+    override func tearDown() {
+        agent = nil
+        StubURLProtocol.uninstall()
+        super.tearDown()
+    }
+
+    /// Drop after `droppedAt` bytes, then answer the retry with 206 and the rest of the body
+    func testRetryResumesAfterReceivedPrefix() {
+        StubURLProtocol.install { [unowned self] request in
+            guard request.value(forHTTPHeaderField: "Range") != nil else {
+                return self.interruptedReply()
+            }
+            return StubURLProtocol.Reply(
+                statusCode: 206,
+                headers: [
+                    "Content-Range": "bytes \(self.droppedAt)-\(self.body.count - 1)/\(self.body.count)",
+                    "Content-Length": "\(self.body.count - self.droppedAt)",
+                    "ETag": self.etag
+                ],
+                body: self.body.subdata(in: self.droppedAt..<self.body.count)
+            )
+        }
+
+        XCTAssertEqual(download(), body)
+
+        let requests = StubURLProtocol.requests
+        XCTAssertEqual(requests.count, 2)
+        XCTAssertNil(requests.first?.value(forHTTPHeaderField: "Range"))
+        XCTAssertEqual(requests.last?.value(forHTTPHeaderField: "Range"), "bytes=\(droppedAt)-")
+        XCTAssertEqual(requests.last?.value(forHTTPHeaderField: "If-Range"), etag)
+    }
+
+    /// The resource changed (If-Range failed): a 200 answer replaces the prefix instead of extending it
+    func testRetryRestartsWhenServerAnswers200() {
+        StubURLProtocol.install { [unowned self] request in
+            guard request.value(forHTTPHeaderField: "Range") != nil else {
+                return self.interruptedReply()
+            }
+            return StubURLProtocol.Reply(
+                headers: ["Content-Length": "\(self.body.count)", "ETag": "\"v2\""],
+                body: self.body
+            )
+        }
+
+        XCTAssertEqual(download(), body)
+
+        let requests = StubURLProtocol.requests
+        XCTAssertEqual(requests.count, 2)
+        XCTAssertEqual(requests.last?.value(forHTTPHeaderField: "Range"), "bytes=\(droppedAt)-")
+    }
+
+    // MARK: - PartialDownload
+
+    func testPartialDownloadMatchesOnlyContinuingRange() {
+        let partial = PartialDownload(data: Data(count: droppedAt), response: okResponse(headers: [
+            "Accept-Ranges": "bytes",
+            "ETag": etag
+        ]))!
+
+        XCTAssertTrue(partial.isContinued(by: response(206, ["Content-Range": "bytes \(droppedAt)-249999/250000"])))
+        XCTAssertFalse(partial.isContinued(by: response(206, ["Content-Range": "bytes 0-249999/250000"])))
+        XCTAssertFalse(partial.isContinued(by: okResponse(headers: [:])))
+    }
+
+    func testPartialDownloadNeedsRangesAndStrongValidator() {
+        let data = Data(count: droppedAt)
+        XCTAssertNil(PartialDownload(data: data, response: okResponse(headers: ["ETag": etag])))
+        XCTAssertNil(PartialDownload(data: data, response: okResponse(headers: ["Accept-Ranges": "bytes", "ETag": "W/\"v1\""])))
+        XCTAssertNil(PartialDownload(data: data, response: response(206, ["Accept-Ranges": "bytes", "ETag": etag])))
+    }
+
+    func testStoreKeepsOnlyResumablePrefixes() {
+        let store = PartialDownloadStore(memoryLimit: 1024 * 1024)
+        let headers = ["Accept-Ranges": "bytes", "ETag": etag]
+        let small = PartialDownload(data: Data(count: PartialDownloadStore.minimumResumableBytes - 1), response: okResponse(headers: headers))!
+        let large = PartialDownload(data: Data(count: droppedAt), response: okResponse(headers: headers))!
+
+        store.store(small, for: "small")
+        store.store(large, for: "large")
+
+        XCTAssertNil(store.take(for: "small"))
+        XCTAssertEqual(store.take(for: "large")?.data.count, droppedAt)
+        XCTAssertNil(store.take(for: "large"))
+    }
+
+    // MARK: - Helpers
+
+    /// Resumable 200 answer whose connection drops after `droppedAt` bytes
+    private func interruptedReply() -> StubURLProtocol.Reply {
+        StubURLProtocol.Reply(
+            headers: ["Accept-Ranges": "bytes", "ETag": etag, "Content-Length": "\(body.count)"],
+            body: body.prefix(droppedAt),
+            error: URLError(.networkConnectionLost)
+        )
+    }
+
+    /// Body handed to storage, before decoding (the stub body is not an image)
+    private func download() -> Data? {
+        let finished = expectation(description: "download finished")
+        var received: Data?
+        _ = agent.downloadData(at: url, data: { received = $0 }) { _, _ in
+            finished.fulfill()
+        }
+        wait(for: [finished], timeout: 10)
+        return received
+    }
+
+    private func okResponse(headers: [String: String]) -> HTTPURLResponse {
+        response(200, headers)
+    }
+
+    private func response(_ statusCode: Int, _ headers: [String: String]) -> HTTPURLResponse {
+        HTTPURLResponse(url: url, statusCode: statusCode, httpVersion: "HTTP/1.1", headerFields: headers)!
+    }
+}
@@ -0,0 +1,28 @@
+//
+//  RetryPolicyTests.swift
+//  ImageDownloaderTests
+//
+//  Jittered retry delays
+//
+
+import XCTest
+@testable import ImageDownloader
+
+final class RetryPolicyTests: XCTestCase {
+    private let policy = RetryPolicy(maxRetries: 3, baseDelay: 1, maxDelay: 30)
+
+    /// Requests failing together must not all retry after exactly `baseDelay`
+    func testFirstRetryDelaysAreSpread() {
+        let delays = (0..<100).map { _ in policy.jitteredDelay(previousDelay: 0) }
+
+        XCTAssertTrue(delays.allSatisfy { (1...3).contains($0) })
+        XCTAssertGreaterThan(Set(delays).count, 1)
+    }
+
+    func testLaterDelaysGrowFromPreviousAndStayCapped() {
+        let delays = (0..<100).map { _ in policy.jitteredDelay(previousDelay: 20) }
+
+        XCTAssertTrue(delays.allSatisfy { (1...30).contains($0) })
+        XCTAssertTrue(delays.contains { $0 > 3 })
+    }
+}
@@ -0,0 +1,153 @@
+//
+//  StubURLProtocol.swift
+//  ImageDownloaderTests
+//
+//  In-process network for NetworkAgent tests: canned replies, injected latency, dropped connections
+//
+
+import Foundation
+@testable import ImageDownloader
+
+/// URLProtocol answering NetworkAgent requests from the handler of the running test
+/// Requests go to the real network when no handler is installed
+final class StubURLProtocol: URLProtocol {
+
+    /// Canned answer to one request
+    struct Reply {
+        var statusCode: Int = 200
+        var headers: [String: String] = [:]
+        var body = Data()
+        /// Seconds before the response is sent
+        var delay: TimeInterval = 0
+        /// Fail with this error after sending `body` instead of finishing
+        var error: Error?
+    }
+
+    typealias Handler = (URLRequest) -> Reply
+
+    private static let lock = NSLock()
+    private static var handler: Handler?
+    private static var recordedRequests: [URLRequest] = []
+    private static var inFlight = 0
+
+    /// The shared session reads `NetworkAgent.protocolClasses` once, register before any download
+    private static let registration: Void = {
+        NetworkAgent.protocolClasses = [StubURLProtocol.self]
+    }()
+
+    /// Answer every request with `handler` until `uninstall()`
+    static func install(_ handler: @escaping Handler) {
+        _ = registration
+        lock.lock()
+        self.handler = handler
+        recordedRequests = []
+        inFlight = 0
+        lock.unlock()
+    }
+
+    static func uninstall() {
+        lock.lock()
+        handler = nil
+        recordedRequests = []
+        lock.unlock()
+    }
+
+    /// Requests received since `install(_:)`, in arrival order
+    static var requests: [URLRequest] {
+        lock.lock()
+        defer { lock.unlock() }
+        return recordedRequests
+    }
+
+    /// Requests started and not answered yet, including the one being handled
+    static var inFlightCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return inFlight
+    }
+
+    // MARK: - Private State (Access only with lock)
+
+    private let stateLock = NSLock()
+    private var isStopped = false
+    private var isFinished = false
+
+    // MARK: - URLProtocol
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return handler != nil
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        request
+    }
+
+    override func startLoading() {
+        Self.lock.lock()
+        Self.recordedRequests.append(request)
+        Self.inFlight += 1
+        let handler = Self.handler
+        Self.lock.unlock()
+
+        guard let reply = handler?(request), let url = request.url else {
+            finish { $0.urlProtocol(self, didFailWithError: URLError(.cannotConnectToHost)) }
+            return
+        }
+
+        DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + reply.delay) { [self] in
+            let response = HTTPURLResponse(
+                url: url,
+                statusCode: reply.statusCode,
+                httpVersion: "HTTP/1.1",
+                headerFields: reply.headers
+            )!
+            finish { client in
+                client.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+                if !reply.body.isEmpty {
+                    client.urlProtocol(self, didLoad: reply.body)
+                }
+                if let error = reply.error {
+                    client.urlProtocol(self, didFailWithError: error)
+                } else {
+                    client.urlProtocolDidFinishLoading(self)
+                }
+            }
+        }
+    }
+
+    override func stopLoading() {
+        stateLock.lock()
+        isStopped = true
+        stateLock.unlock()
+        markFinished()
+    }
+
+    // MARK: - Private
+
+    /// Deliver the answer unless the task was cancelled meanwhile
+    private func finish(_ deliver: (URLProtocolClient) -> Void) {
+        stateLock.lock()
+        let isStopped = self.isStopped
+        stateLock.unlock()
+
+        markFinished()
+        if !isStopped, let client = client {
+            deliver(client)
+        }
+    }
+
+    /// Release the in-flight slot once
+    private func markFinished() {
+        stateLock.lock()
+        let wasFinished = isFinished
+        isFinished = true
+        stateLock.unlock()
+
+        guard !wasFinished else { return }
+        Self.lock.lock()
+        Self.inFlight -= 1
+        Self.lock.unlock()
+    }
+}
@@ -0,0 +1,26 @@
+//
+//  TestImages.swift
+//  ImageDownloaderTests
+//
+//  Small generated images and their encoded bytes
+//
+
+import UIKit
+
+enum TestImages {
+    /// Opaque image of the given pixel size
+    static func image(width: Int = 1, height: Int = 1, color: UIColor = .red) -> UIImage {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        format.opaque = true
+        let size = CGSize(width: width, height: height)
+        return UIGraphicsImageRenderer(size: size, format: format).image { context in
+            color.setFill()
+            context.fill(CGRect(origin: .zero, size: size))
+        }
+    }
+
+    static func pngData(width: Int = 1, height: Int = 1, color: UIColor = .red) -> Data {
+        image(width: width, height: height, color: color).pngData()!
+    }
+}